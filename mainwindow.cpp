@@ -35,9 +35,18 @@ MainWindow::MainWindow(QWidget *parent)
     drag_position_            = QPoint();
     prereq_combo_box_         = std::make_unique<QStringListModel>();
     depend_combo_box_         = std::make_unique<QStringListModel>();
-    list_changed_             = false;
+    task_list_model_          = std::make_unique<TaskListModel>();
     task_list_dir_            = QDir(QDir::homePath());
     debug_mode_               = false;
+    compress_lists_           = QSettings("Cynical Tech Humor", "Telos").value("CompressLists", false).toBool();
+    display_pending_          = kDisplayNone;
+    display_rendering_        = kDisplayNone;
+    autosave_                 = QSettings("Cynical Tech Humor", "Telos").value("Autosave", false).toBool();
+
+    // Autosave once edits have stopped for the saved delay
+    autosave_timer_.setSingleShot(true);
+    autosave_timer_.setInterval(QSettings("Cynical Tech Humor", "Telos").value("AutosaveDelaySecs", AUTOSAVE_DELAY_SECS).toInt() * 1000);
+    connect(&autosave_timer_, &QTimer::timeout, this, &MainWindow::AutosaveTaskLists);
 
     // Make a task list directory if one doesn't exist, and sets filters/sorting
     task_list_dir_.mkdir          ("Telos");
@@ -45,15 +54,50 @@ MainWindow::MainWindow(QWidget *parent)
     task_list_dir_.setFilter      (QDir::Files | QDir::Readable | QDir::Writable);
     task_list_dir_.setSorting     (QDir::Name);
     task_list_dir_.setNameFilters (QStringList("*.dat"));
+    manifest_ = TaskListManifest(task_list_dir_.path());
 
-    // Sets combo boxes to be edited by the QStringListModels
+    // Sets combo boxes to be edited by the QStringListModels, and menu options to their saved settings
+    ui->actionCompressLists->setChecked(compress_lists_);
+    ui->actionAutosave->     setChecked(autosave_);
     ui->comboPrerequisites->setModel(prereq_combo_box_.get());
     ui->comboDependencies-> setModel(depend_combo_box_.get());
+    ui->lvTaskList->        setModel(task_list_model_.get());
+
+    // Large lists are sorted in the background and land as a model reset, which drops the view's selection
+    connect(task_list_model_.get(), &QAbstractItemModel::modelReset, this, [this]()
+    {
+        SelectActiveTask();
+        ScheduleDisplay(kDisplayActiveTask);
+    });
+
+    // Find all task lists in default directory: those matching the manifest are loaded when first selected,
+    // the rest are read now, in parallel
+    manifest_.Read();
+    QStringList               task_list_names = task_list_dir_.entryList();
+    std::vector<TaskFileLoad> task_list_loads;
+    manifest_.RetainFiles(task_list_names);
+    for (const QString& i : task_list_names)
+    {
+        const TaskListManifest::Entry* entry = manifest_.FindFile(i);
+        if (entry && manifest_.IsCurrent(*entry)) continue;
+        task_list_loads.emplace_back();
+        task_list_loads.back().path = task_list_dir_.path() + "\\" + i;
+    }
+    QtConcurrent::blockingMap(task_list_loads, [](TaskFileLoad& i_load) { i_load.Read(true); });
+    for (TaskFileLoad& i : task_list_loads)
+    {
+        QString file_name = i.path.mid(task_list_dir_.path().size() + 1);
+        if (!AddLoadedTaskList(std::move(i), false)) manifest_.RemoveEntry(file_name);
+    }
+    manifest_.Write();
 
-    // Load all task lists found in default directory
-    QStringList task_list_names = task_list_dir_.entryList();
-    for (int i=0; i<task_list_names.size(); ++i)
-        LoadTaskListFromFile(task_list_names[i]);
+    // Pick up changes made to the directory elsewhere, once it has been quiet for a moment
+    reload_timer_.setSingleShot(true);
+    reload_timer_.setInterval(RELOAD_DELAY_MSECS);
+    connect(&dir_watcher_,  &QFileSystemWatcher::directoryChanged, &reload_timer_, qOverload<>(&QTimer::start));
+    connect(&dir_watcher_,  &QFileSystemWatcher::fileChanged,      &reload_timer_, qOverload<>(&QTimer::start));
+    connect(&reload_timer_, &QTimer::timeout,                      this,           &MainWindow::ReloadChangedTaskLists);
+    WatchTaskListDir();
 
     // Initalize most displayed fields
     UpdateDisplayOpenTaskLists();
@@ -72,6 +116,12 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    // Autosave what hasn't been yet, let background saves and compactions finish, so no change is lost,
+    // then record the lists as saved
+    if (autosave_) AutosaveTaskLists();
+    for (const QString& i : running_jobs_.keys())
+        WaitForFileJobs(i);
+    manifest_.Write();
     delete ui;
 }
 
@@ -79,14 +129,192 @@ TaskList* MainWindow::GetOpenTaskListPtr(QString i_name)
 {
     for (int i=0; i<open_task_lists_.size(); ++i)
         if (open_task_lists_[i]->GetTaskListName() == i_name) return open_task_lists_[i].get();
-    return nullptr;
+
+    // Not loaded: load it if the manifest has it, forgetting it if it can't be read
+    const TaskListManifest::Entry* entry = manifest_.FindList(i_name);
+    if (!entry) return nullptr;
+    QString      file_name = entry->file_name;
+    TaskFileLoad load;
+    load.path = task_list_dir_.path() + "\\" + file_name;
+    load.Read(true);
+    if (!AddLoadedTaskList(std::move(load), false))
+    {
+        manifest_.RemoveEntry(file_name);
+        return nullptr;
+    }
+    return open_task_lists_.back().get();
+}
+
+void MainWindow::UpdateManifest(const QString& i_path, const QString& i_list_name, uint32_t i_task_count)
+{
+    QString dir_prefix = task_list_dir_.path() + "\\";
+    if (i_path.startsWith(dir_prefix))
+        manifest_.SetEntry(i_path.mid(dir_prefix.size()), i_list_name, i_task_count);
+}
+
+void MainWindow::EvictIdleTaskLists(void)
+{
+    // Only lists whose every change is on disk (and listed in the manifest, so they can be loaded again) are dropped
+    if (LIST_EVICT_MSECS == 0) return;
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (size_t i=open_task_lists_.size(); i-- > 0;)
+    {
+        TaskList* list      = open_task_lists_[i].get();
+        QString   file_name = GetTaskListFileName(list->GetTaskListName());
+        if (list == active_task_list_ || list->IsTaskListDirty() || !list->GetJournalId()
+         || now - list_last_used_.value(list, now) < LIST_EVICT_MSECS
+         || running_jobs_.contains(task_list_dir_.path() + "\\" + file_name)
+         || !manifest_.FindFile(file_name) || manifest_.FindFile(file_name)->list_name != list->GetTaskListName())
+            continue;
+        list_last_used_.remove(list);
+        open_task_lists_.erase(open_task_lists_.begin() + i);
+    }
+}
+
+void MainWindow::ReleaseFileBuffer(TaskList* i_list)
+{
+    int lost_count = i_list->ReleaseFileBuffer();
+    if (lost_count)
+        emit SignalStatus(QtWarningMsg, "Couldn't read " + QString::number(lost_count) + " description(s) of task list \""
+                                        + i_list->GetTaskListName() + "\": the file it was loaded from has changed since.");
+}
+
+void MainWindow::WatchTaskListDir(void)
+{
+    // Files replaced by renaming another file over them (as saves do) stop being watched, so watch the current ones
+    QString     dir_prefix = task_list_dir_.path() + "\\";
+    QStringList watched    = dir_watcher_.files(),
+                missing;
+    for (const QString& i : task_list_dir_.entryList(QStringList{"*.dat", "*.journal"}, QDir::Files))
+        if (!watched.contains(dir_prefix + i)) missing.push_back(dir_prefix + i);
+    if (dir_watcher_.directories().isEmpty()) dir_watcher_.addPath(task_list_dir_.path());
+    if (!missing.isEmpty())                   dir_watcher_.addPaths(missing);
+}
+
+void MainWindow::ReloadChangedTaskLists(void)
+{
+    // Redisplaying would throw away edits to the active task that haven't been applied: try again later
+    if (ui->pbSaveChanges->isEnabled())
+    {
+        reload_timer_.start();
+        return;
+    }
+    WatchTaskListDir();
+
+    // Only loaded lists are brought up to date in place; the others are read when they're first selected
+    auto FindLoadedList = [this](const QString& i_name) -> TaskList*
+    {
+        for (const TaskList::PtrUnique& i : open_task_lists_)
+            if (i->GetTaskListName() == i_name) return i.get();
+        return nullptr;
+    };
+    QString     dir_prefix   = task_list_dir_.path() + "\\";
+    QStringList file_names   = task_list_dir_.entryList();
+    bool        flag_changed = false;
+
+    // Files removed elsewhere: close their lists, unless they have unsaved changes
+    // Those are saved in full next time, since the journal has nothing to continue
+    QStringList removed_files;
+    for (const TaskListManifest::Entry& i : manifest_.GetEntries())
+        if (!file_names.contains(i.file_name) && !running_jobs_.contains(dir_prefix + i.file_name))
+            removed_files.push_back(i.file_name);
+    for (const QString& i : removed_files)
+    {
+        TaskList* list = FindLoadedList(manifest_.FindFile(i)->list_name);
+        manifest_.RemoveEntry(i);
+        flag_changed = true;
+        if (list && list->IsTaskListDirty())
+        {
+            list->SetJournalId(0);
+            emit SignalStatus(QtWarningMsg, "Task list \"" + list->GetTaskListName() + "\" was removed from disk elsewhere: it will be saved again with your changes.");
+        }
+        else if (list)
+        {
+            emit SignalStatus(QtInfoMsg, "Closed task list \"" + list->GetTaskListName() + "\": it was removed from disk elsewhere.");
+            if (list == active_task_list_)
+            {
+                active_task_list_ = nullptr;
+                active_task_      = nullptr;
+            }
+            list_last_used_.remove(list);
+            open_task_lists_.erase(std::find_if(open_task_lists_.begin(), open_task_lists_.end(),
+                                                [list](const TaskList::PtrUnique& i_list) { return i_list.get() == list; }));
+        }
+    }
+
+    // Files added or changed elsewhere; files being written here are left until the write finishes
+    for (const QString& i : file_names)
+    {
+        QString                        path  = dir_prefix + i;
+        const TaskListManifest::Entry* entry = manifest_.FindFile(i);
+        if ((entry && manifest_.IsCurrent(*entry)) || running_jobs_.contains(path)) continue;
+        TaskList* list = entry ? FindLoadedList(entry->list_name) : nullptr;
+        flag_changed = true;
+
+        // Read the file again; new files are added as lists, and lists not loaded only need their entry updated
+        TaskFileLoad load;
+        load.path = path;
+        load.Read(true);
+
+        // Unsaved changes win; the file is overwritten by the next save
+        // Descriptions not read yet are read from the new file instead, as the old one is gone
+        if (list && list->IsTaskListDirty())
+        {
+            if (load.list) list->TakeFileBuffer(*load.list);
+            emit SignalStatus(QtWarningMsg, "Task list \"" + list->GetTaskListName() + "\" was changed on disk elsewhere: keeping your unsaved changes.");
+            UpdateManifest(path, list->GetTaskListName(), list->GetTaskListSize());
+            continue;
+        }
+        if (!load.list)
+        {
+            emit SignalStatus(QtWarningMsg, "Failed to reload \"" + path + "\": " + load.error + ".");
+            continue;
+        }
+        if (!entry)
+        {
+            AddLoadedTaskList(std::move(load), false);
+            continue;
+        }
+        if (!list)
+        {
+            UpdateManifest(path, load.list->GetTaskListName(), load.list->GetTaskListSize());
+            continue;
+        }
+
+        // Apply only the tasks that differ, without logging them as changes to save
+        // The active task is cleared meanwhile (the sync resets the view), then found again by name
+        QString active_name = (list == active_task_list_ && active_task_) ? active_task_->GetTaskName() : QString();
+        int     added, changed, removed;
+        if (list == active_task_list_) active_task_ = nullptr;
+        list->SetChangeLogging(false);
+        list->SyncTaskList(*load.list, &added, &changed, &removed);
+        list->SetChangeLogging(true);
+        list->SetJournalId(load.list->GetJournalId());
+        if (list == active_task_list_)
+            active_task_ = active_name.isEmpty() ? nullptr : list->GetPtrFromTaskList(active_name);
+
+        // Follow a rename, unless another list already has the name
+        QString list_name = load.list->GetTaskListName();
+        if (list_name != list->GetTaskListName() && !IsDuplicateTaskListTitle(list_name))
+        {
+            if (list == active_task_list_ && ui->lwOpenTaskLists->currentItem())
+                ui->lwOpenTaskLists->currentItem()->setText(list_name);
+            list->SetTaskListName(list_name);
+        }
+        UpdateManifest(path, list->GetTaskListName(), list->GetTaskListSize());
+        emit SignalStatus(QtInfoMsg, "Reloaded task list \"" + list->GetTaskListName() + "\" after it changed on disk: "
+                                     + QString::number(added) + " added, " + QString::number(changed) + " changed, " + QString::number(removed) + " removed.");
+    }
+
+    // Redisplay, keeping the selected list and task
+    if (flag_changed) ScheduleDisplay(kDisplayOpenLists);
 }
 
 Task* MainWindow::GetSelectedTask(void)
 {
-    QList<QListWidgetItem *> selected_tasks = ui->lwTaskList->selectedItems();
+    QModelIndexList selected_tasks = ui->lvTaskList->selectionModel()->selectedIndexes();
     return (!active_task_list_ || selected_tasks.empty()) ?
-           nullptr : active_task_list_->GetPtrFromTaskList(selected_tasks.first()->text());
+           nullptr : task_list_model_->GetTask(selected_tasks.first());
 }
 
 void MainWindow::SelectPrereqToChange(TaskSelection i_select)
@@ -95,26 +323,13 @@ void MainWindow::SelectPrereqToChange(TaskSelection i_select)
     if (!active_task_)      throw std::logic_error("ChangedPrereq failed: no active task");
     if (!active_task_list_) throw std::logic_error("ChangedPrereq failed: no active task list");
 
-    // If adding prerequisite(s)...
+    // If adding prerequisite(s), ask the task list for eligible tasks: it excludes completed tasks,
+    // dependents of the active task (cycles), and the current prerequisites with their chains (redundant)
     QStringList eligible;
     if(i_select == TaskSelection::kAddPrerequisite)
     {
-        QStringList prereq = prereq_combo_box_->stringList(),
-                    prereq_chain,
-                    depend_chain,
-                    completed;
-
-        // ...get prerequisite chain, dependent chain, and completed tasks...
-        for (int i=0; i<prereq.size(); ++i)
-            active_task_list_->GetChainedPrereq(&prereq_chain, prereq[i]);
-        active_task_list_->GetChainedDepend(&depend_chain, active_task_->GetTaskName());
-        active_task_list_->GetCompleted    (&completed);
-
-        // ...then remove them from the list of all tasks to leave only eligible ones
-        eligible = active_task_list_->GetAllTaskNamesFromList();
-        eligible = Task::SubtractTaskNames(eligible, prereq_chain);
-        eligible = Task::SubtractTaskNames(eligible, depend_chain);
-        eligible = Task::SubtractTaskNames(eligible, completed);
+        Task::PtrVector prereq = active_task_list_->GetPtrsFromTaskList(prereq_combo_box_->stringList());
+        eligible = Task::GetTaskNames(active_task_list_->GetEligiblePrereq(active_task_, prereq));
     }
     // If removing prerequisite(s), get current unchained prerequisites
     else if (i_select == TaskSelection::kRemovePrerequisite)
@@ -138,22 +353,25 @@ void MainWindow::ChangePrereq(QStringList i_list, TaskSelection i_select)
     // If adding preprequisites, iterate through incoming prerequisite chains
     // If a current prerequisite matches a chained prerequisite, remove the current one.
     // (The current one is redundant in this situation)
-    QString status;
+    QString         status;
+    Task::PtrVector selected = active_task_list_->GetPtrsFromTaskList(i_list),
+                    current  = active_task_list_->GetPtrsFromTaskList(prereq_combo_box_->stringList());
     if (i_select == TaskSelection::kAddPrerequisite)
     {
-        QStringList prereqs_of_prereqs;
-        for (int i=0; i<i_list.size(); i++)
+        Task::PtrVector prereqs_of_prereqs;
+        for (Task* i : selected)
         {
-            active_task_list_->GetChainedPrereq(&prereqs_of_prereqs, i_list[i]);
-            prereqs_of_prereqs = Task::SubtractTaskNames(prereqs_of_prereqs, i_list);
+            Task::PtrVector chain = active_task_list_->GetPtrsFromIds(active_task_list_->GetChainedPrereq(i));
+            prereqs_of_prereqs.insert(prereqs_of_prereqs.end(), chain.begin(), chain.end());
         }
-        prereq_combo_box_->setStringList(Task::SubtractTaskNames((prereq_combo_box_->stringList() + i_list), prereqs_of_prereqs));
+        prereqs_of_prereqs = Task::SubtractTasks(prereqs_of_prereqs, selected);
+        prereq_combo_box_->setStringList(Task::GetTaskNames(Task::SubtractTasks(Task::UniteTasks(current, selected), prereqs_of_prereqs)));
         status = "Added selected prerequisites to task \"" + active_task_->GetTaskName() + "\"";
     }
     // If removing prerequisites, remove input prerequisites from current prerequisites
     else if (i_select == TaskSelection::kRemovePrerequisite)
     {
-        prereq_combo_box_->setStringList(Task::SubtractTaskNames(prereq_combo_box_->stringList(), i_list));
+        prereq_combo_box_->setStringList(Task::GetTaskNames(Task::SubtractTasks(current, selected)));
         status = "Removed selected prerequisites from task \"" + active_task_->GetTaskName() + "\"";
     }
 
@@ -186,21 +404,19 @@ void MainWindow::SaveActiveTask(void)
     SetActiveTaskCompleted   (ui->cbCompleted  ->isChecked(),  ui->dtCompleted->dateTime() );
 
     // Assemble lists of previous, current, added, and removed prerequisites
-    QStringList previous_prereq = Task::GetTaskNames(active_task_saved_prereq_);
-    QStringList current_prereq  = prereq_combo_box_->stringList();
-    QStringList added_prereq    = Task::SubtractTaskNames(current_prereq, previous_prereq);
-    QStringList removed_prereq  = Task::SubtractTaskNames(previous_prereq, current_prereq);
-
-    // Add active task ptr to dependencies of added prerequisite tasks
-    // Remove active task ptr from dependencies of removed prerequisite tasks
-    for(int i=0; i<added_prereq.size(); ++i)
-        active_task_list_->GetPtrFromTaskList(added_prereq[i])->AddTaskDepend(active_task_);
-    for(int i=0; i<removed_prereq.size(); ++i)
-        active_task_list_->GetPtrFromTaskList(removed_prereq[i])->RemoveTaskDepend(active_task_);
-
-    // Save current list of prerequisites to the active task, and flag list change
-    active_task_->SetTaskPrereq(active_task_list_->GetPtrsFromTaskList(current_prereq));
-    list_changed_ = true;
+    Task::PtrVector current_prereq = active_task_list_->GetPtrsFromTaskList(prereq_combo_box_->stringList());
+    Task::PtrVector added_prereq   = Task::SubtractTasks(current_prereq, active_task_saved_prereq_);
+    Task::PtrVector removed_prereq = Task::SubtractTasks(active_task_saved_prereq_, current_prereq);
+
+    // Link added prerequisites to the active task, and unlink removed ones
+    // (the active task's entry in each prerequisite's dependents is kept in sync by the task list)
+    for (Task* i : added_prereq)
+        active_task_list_->AddTaskPrereq(active_task_, i);
+    for (Task* i : removed_prereq)
+        active_task_list_->RemoveTaskPrereq(active_task_, i);
+
+    // The list logs the change; autosave it once edits stop
+    ScheduleAutosave();
     QString status = "Saved changes to task \"" + active_task_->GetTaskName() + "\".";
     emit SignalStatus(QtInfoMsg, status);
 }
@@ -216,9 +432,9 @@ void MainWindow::CreateTask(void)
     while(active_task_list_->GetPtrFromTaskList(unique_task_name + QString::number(i)))
         i++;
 
-    // Create a task with the assembled name to the active task list, and flag list change
+    // Create a task with the assembled name to the active task list, and schedule an autosave
     active_task_ = active_task_list_->AddTaskToList(unique_task_name + QString::number(i));
-    list_changed_ = true;
+    ScheduleAutosave();
     QString status = "Created new task \"" + active_task_->GetTaskName() + "\".";
     emit SignalStatus(QtInfoMsg, status);
 }
@@ -233,9 +449,9 @@ void MainWindow::RemoveTask(void)
     QString task_name = active_task_->GetTaskName();
     active_task_list_->RemoveTaskFromList(active_task_);
 
-    // Set the active task ptr to null and flag list change
+    // Set the active task ptr to null and schedule an autosave
     active_task_ = nullptr;
-    list_changed_ = true;
+    ScheduleAutosave();
 
     QString status = "Removed task \"" + task_name + "\" from list.";
     emit SignalStatus(QtInfoMsg, status);
@@ -272,6 +488,7 @@ void MainWindow::CreateTaskList(void)
 
     // ...otherwise, create list with the input name, add it to the open lists, and save to disk
     open_task_lists_.push_back(std::make_unique<TaskList>(list_name));
+    open_task_lists_.back()->SetChangeLogging(true);
     SaveTaskListToFile(GetOpenTaskListPtr(list_name), TaskListSave::kNew);
     emit SignalStatus(QtInfoMsg, QString("Created new task list \"") + list_name + "\"");
 }
@@ -300,6 +517,7 @@ bool MainWindow::RemoveTaskList(TaskList*& i_list)
     {
         if (open_task_lists_[i].get() == i_list)
         {
+            list_last_used_.remove(i_list);
             open_task_lists_.erase(open_task_lists_.begin() + i);
             found = true;
         }
@@ -308,9 +526,13 @@ bool MainWindow::RemoveTaskList(TaskList*& i_list)
         throw std::logic_error("Invalid input to RemoveTaskList(), input list not found in open task lists");
     i_list = nullptr;
 
-    // Remove the file, return false if it can not be removed
+    // Remove the file and its journal, return false if the file can not be removed
     // Otherwise return true
-    QFile removed_file((task_list_dir_.path() + "\\" + removed_file_name + ".dat").toLocal8Bit());
+    QString removed_path = task_list_dir_.path() + "\\" + removed_file_name + ".dat";
+    WaitForFileJobs(removed_path);
+    manifest_.RemoveEntry(removed_file_name + ".dat");
+    QFile::remove(TaskJournal::GetPath(removed_path));
+    QFile removed_file(removed_path.toLocal8Bit());
     if (!removed_file.remove())
     {
         QString status = "Failed to remove task list " + removed_file_name + " from disk.";
@@ -398,8 +620,8 @@ bool MainWindow::SaveTaskListToFile(TaskList* i_list, TaskListSave i_save_type)
         save_name.prepend(task_list_dir_.path() + "\\");
         save_name.append(file_ext);
     }
-    // If saving new, make the file in the reserved Telos space
-    else if (i_save_type == TaskListSave::kNew)
+    // If saving new (or autosaving), make the file in the reserved Telos space under the list's own name
+    else if (i_save_type == TaskListSave::kNew || i_save_type == TaskListSave::kAuto)
     {
         save_name = stored_name;
         MainWindow::ConvertSpaceToUnderscore(save_name);
@@ -407,166 +629,242 @@ bool MainWindow::SaveTaskListToFile(TaskList* i_list, TaskListSave i_save_type)
         save_name.append(file_ext);
     }
 
-    // Opens save file - exit without saving if file cannot be opened
-    QFile save_file(save_name.toLocal8Bit());
-    if (!save_file.open(QIODevice::WriteOnly))
+    // A list saved under the same name only needs its changes appended to the journal, unless a full save
+    // of it is still waiting to be written. If appending fails, fall back to saving the whole list
+    bool flag_journal = i_save_type == TaskListSave::kActive || i_save_type == TaskListSave::kAuto || i_save_type == TaskListSave::kNew;
+    if (flag_journal && i_save_type != TaskListSave::kNew && !flag_name_changed && i_list->GetJournalId()
+     && !IsSavePending(save_name) && AppendTaskListJournal(i_list, save_name))
+        return true;
+
+    // CSV files are exported in the background as quoted text, from a snapshot of the list
+    // Exit without saving if no field delineator is chosen
+    if (file_ext == ".csv")
     {
-        QString status = "Failed to open save file \"" + save_name + "\": save aborted.";
-        emit SignalStatus(QtWarningMsg, status);
-        return false;
+        char divide_field;
+        if (!SelectCsvDivideField(&divide_field))
+        {
+            QString status = "No delineation character selected: export aborted.";
+            emit SignalStatus(QtWarningMsg, status);
+            return false;
+        }
+        QueueSave(i_list, save_name, i_save_type, 0, QString(), divide_field);
+        return true;
     }
 
-    // ****************************************************************************************
-    // Save file (with the appropriate name) should have been successfully opened by this point
-    // Begin assembling data from list to file
-    // ****************************************************************************************
-
-    // Construct default delineators for Telos .dat file
-    QByteArray my_line_begin,
-               my_divide_task,
-               my_divide_field,
-               my_divide_subfield,
-               my_line_end;
-
-    // If .dat file, use the Telos-defined delineators. No begin/end line necessary
-    if (file_ext == ".dat")
+    // .dat files are written in the background from a snapshot of the list
+    // A list saved into the Telos directory replaces its file, so it lets go of that first, and starts a new, empty journal
+    uint64_t journal_id = 0;
+    if (flag_journal)
     {
-        my_divide_task.    append(MainWindow::DIVIDE_TASK    );
-        my_divide_field.   append(MainWindow::DIVIDE_FIELD   );
-        my_divide_subfield.append(MainWindow::DIVIDE_SUBFIELD);
+        ReleaseFileBuffer(i_list);
+        journal_id = TaskJournal::NewId();
+        i_list->SetJournalId(journal_id);
+        i_list->TakeChanges();
     }
-    // If .csv file, prompt the user for the desired field delineation (comma, tab, colon)
-    // Add additional formatting to put every entry in quotes, and new lines for task delineation
-    else
-    {
-        bool ok;
-        QStringList delineation_options;
-        delineation_options << tr("Comma") << tr("Tab")<< tr("Colon");
-        QString select_delineate = QInputDialog::getItem(this,
-                                                         tr("Select delineation character"),
-                                                         tr("Select delineation character for CSV export"),
-                                                         delineation_options,
-                                                         0,
-                                                         false,
-                                                         &ok);
-        if (ok && !select_delineate.isEmpty())
-        {
-            if     (select_delineate=="Comma") my_divide_field.append(',');
-            else if(select_delineate=="Tab")   my_divide_field.append('\t');
-            else if(select_delineate=="Colon") my_divide_field.append(':');
-            else                               my_divide_field.append(',');
-        }
 
-        // New line to delineate entries (typical CSV format)
-        my_divide_task.append('\n');
+    // If saving active & name changed, the previous save file is removed once the new one is written
+    QString previous_path;
+    if (flag_name_changed)
+    {
+        MainWindow::ConvertSpaceToUnderscore(stored_name);
+        previous_path = task_list_dir_.path() + "\\" + stored_name + ".dat";
+        WaitForFileJobs(previous_path);
+        manifest_.RemoveEntry(stored_name + ".dat");
+    }
 
-        // Add quotes at beginning of line, end of line, and before/after the field divide
-        // Assures that every entry is within quotation marks (typical CSV format)
-        my_line_begin.append('\"');
-        my_divide_field.prepend('\"');
-        my_divide_field.append('\"');
-        my_line_end.append('\"');
+    // Return true to indicate the save was started (completion or failure is reported once the write finishes)
+    QueueSave(i_list, save_name, i_save_type, journal_id, previous_path);
+    return true;
+}
 
-        // Uses a simple comma and space for subfield divides
-        my_divide_subfield.append(',');
-        my_divide_subfield.append(' ');
+bool MainWindow::AppendTaskListJournal(TaskList* i_list, const QString& i_file_path)
+{
+    // Write the changes logged since the last save, if any
+    QString                 journal_path = TaskJournal::GetPath(i_file_path),
+                            error;
+    uint64_t                journal_end  = 0;
+    std::vector<TaskChange> changes      = i_list->TakeChanges();
+    if (!changes.empty() && !TaskJournal::Append(journal_path, i_list->GetJournalId(), changes, &journal_end, &error))
+    {
+        emit SignalStatus(QtWarningMsg, "Failed to append changes to \"" + journal_path + "\" (" + error + "): saving the whole list.");
+        return false;
     }
+    UpdateManifest(i_file_path, i_list->GetTaskListName(), i_list->GetTaskListSize());
 
-    // If exporting completed tasks, get the completed list; otherwise, get all the tasks
-    Task::PtrVector save_list;
-    if (active_task_list_)
-            save_list = (i_save_type == TaskListSave::kCompleted) ? active_task_list_->GetAllCompleted() : active_task_list_->GetAllTaskPtrsFromList();
+    // Fold a journal that has grown large back into the .dat file, so loading doesn't replay it all
+    if (!changes.empty() && QFileInfo(journal_path).size() > TaskJournal::COMPACT_SIZE)
+        StartCompaction(i_list, i_file_path, journal_end);
+
+    QString status = "Successfully saved " + QString::number(changes.size()) + " change(s) to task list \"" + i_list->GetTaskListName() + "\".";
+    emit SignalStatus(QtInfoMsg, status);
+    return true;
+}
 
-    // Construct a byte array with all information stored in list by iterating through each task
-    // First entry is the list name: skip if listing completed tasks
-    QByteArray data;
-    if (i_save_type != TaskListSave::kCompleted)
+void MainWindow::QueueSave(TaskList*           i_list,
+                           const QString&      i_path,
+                           TaskListSave        i_save_type,
+                           uint64_t            i_journal_id,
+                           const QString&      i_previous_path,
+                           char                i_csv_divide_field)
+{
+    FileJob job{nullptr, i_list, std::make_shared<const TaskListSnapshot>(*i_list), i_journal_id, 0, i_previous_path, i_save_type, i_csv_divide_field};
+    if (!running_jobs_.contains(i_path))
     {
-        data.append(my_line_begin);
-        data.append(i_list->GetTaskListName().toLocal8Bit());
-        data.append(my_line_end);
+        StartFileJob(i_path, std::move(job));
+        return;
     }
 
-    // All subsequent entries are individual tasks (deliminated by DIVIDE_TASK)
-    for(Task* i : save_list)
-    {
-        // Start new task
-        data.append(my_divide_task);
-        data.append(my_line_begin);
-
-        // Task Name
-        QString my_name = i->GetTaskName();
-        if (file_ext == ".csv") MainWindow::ConvertToDoubleQuotes(my_name);
-        data.append(my_name.toLocal8Bit());
-        data.append(my_divide_field);
-
-        // Task Description: EMPTY for no description
-        QString my_descript = i->GetTaskDescription();
-        if (!my_descript.isEmpty())
+    // Another write of the file is running: wait behind it, replacing (but still finishing the rename of) any waiting save
+    if (queued_saves_.contains(i_path) && job.previous_path.isEmpty())
+        job.previous_path = queued_saves_[i_path].previous_path;
+    queued_saves_.insert(i_path, std::move(job));
+}
+
+void MainWindow::StartCompaction(TaskList* i_list, const QString& i_path, uint64_t i_journal_end)
+{
+    if (running_jobs_.contains(i_path)) return;
+
+    // The .dat file is replaced when the compaction finishes, so the list can't keep descriptions in it
+    ReleaseFileBuffer(i_list);
+    StartFileJob(i_path, FileJob{nullptr, i_list, nullptr, i_list->GetJournalId(), i_journal_end, QString(), TaskListSave::kActive});
+}
+
+void MainWindow::StartFileJob(const QString& i_path, FileJob i_job)
+{
+    // CSV exports write the snapshot a chunk at a time, reporting progress, until done or cancelled
+    // Saves write the snapshot, then remove the journal of the file they replaced (it can't be appended to meanwhile)
+    QFuture<QString> future;
+    bool             flag_csv = i_job.save_type == TaskListSave::kCSV || i_job.save_type == TaskListSave::kCompleted;
+    if (i_job.snapshot && flag_csv)
+        future = QtConcurrent::run([i_path, snapshot = i_job.snapshot, divide_field = i_job.csv_divide_field,
+                                    completed_only = i_job.save_type == TaskListSave::kCompleted](QPromise<QString>& io_promise)
         {
-            if (file_ext == ".csv") MainWindow::ConvertToDoubleQuotes(my_descript);
-            data.append(my_descript.toLocal8Bit());
-        }
-        else data.append(MainWindow::EMPTY);
-        data.append(my_divide_field);
-
-        // Task Deadline: EMPTY for no deadline
-        if (i->GetTaskDeadline().isValid()) data.append(i->GetTaskDeadline().toString().toLocal8Bit());
-        else data.append(MainWindow::EMPTY);
-        data.append(my_divide_field);
-
-        // Task Completed: EMPTY for not complete
-        if (i->GetTaskCompleted().isValid()) data.append(i->GetTaskCompleted().toString().toLocal8Bit());
-        else data.append(MainWindow::EMPTY);
-        data.append(my_divide_field);
-
-        // Task Prerequisites: EMPTY if no prerequisites, otherwise prerequisites seperated by DIVIDE_SUBFIELD
-        Task::PtrVector prereq = i->GetTaskPrereq();
-        if (!prereq.empty())
-            for (int j=0; j<prereq.size(); ++j)
+            io_promise.setProgressRange(0, static_cast<int>(snapshot->tasks.size()));
+            io_promise.addResult(TaskFileCsv::WriteFile(i_path, *snapshot, divide_field, completed_only, [&io_promise](int i_done)
             {
-                QString my_prereq = prereq[j]->GetTaskName();
-                if (file_ext == ".csv") MainWindow::ConvertToDoubleQuotes(my_prereq);
-                data.append(my_prereq.toLocal8Bit());
-                if (j != prereq.size()-1) data.append(my_divide_subfield);
-            }
-        else data.append(MainWindow::EMPTY);
-        data.append(my_divide_field);
+                io_promise.setProgressValue(i_done);
+                return !io_promise.isCanceled();
+            }));
+        });
+    else if (i_job.snapshot)
+        future = QtConcurrent::run([i_path, snapshot = i_job.snapshot, journal_id = i_job.journal_id, compress = compress_lists_ && i_job.journal_id]()
+        {
+            QString error = TaskFileBinary::WriteFile(i_path, *snapshot, journal_id, 0, compress);
+            if (error.isEmpty() && journal_id) QFile::remove(TaskJournal::GetPath(i_path));
+            return error;
+        });
+    else
+        future = QtConcurrent::run(&TaskJournal::Compact, i_path, i_job.journal_id, i_job.journal_end, compress_lists_);
 
-        // Task Dependencies: EMPTY only if no dependencies, otherwise dependencies seperated by DIVIDE_SUBFIELD
-        Task::PtrVector depend = i->GetTaskDepend();
-        if (!depend.empty())
-            for (int j=0; j<depend.size(); ++j)
-            {
-                QString my_depend = depend[j]->GetTaskName();
-                if (file_ext == ".csv") MainWindow::ConvertToDoubleQuotes(my_depend);
-                data.append(my_depend.toLocal8Bit());
-                if (j != depend.size()-1) data.append(my_divide_subfield);
-            }
-        else data.append(MainWindow::EMPTY);
-        data.append(my_line_end);
-    }
+    i_job.watcher = new QFutureWatcher<QString>(this);
+    connect(i_job.watcher, &QFutureWatcher<QString>::finished, this, [this, i_path]() { FinishFileJob(i_path); });
 
-    // Write the data to the save file, close it, and reset the "list changed" flag
-    save_file.write(data);
-    save_file.close();
-    list_changed_=false;
+    // Exports show their progress, if they take long enough to notice, and can be cancelled from it
+    if (flag_csv)
+    {
+        i_job.progress = new QProgressDialog("Exporting task list \"" + i_job.snapshot->name + "\"...", tr("Cancel"), 0, 0, this);
+        i_job.progress->setMinimumDuration(500);
+        i_job.progress->setAutoClose(false);
+        i_job.progress->setAutoReset(false);
+        connect(i_job.watcher,  &QFutureWatcher<QString>::progressRangeChanged, i_job.progress, &QProgressDialog::setRange);
+        connect(i_job.watcher,  &QFutureWatcher<QString>::progressValueChanged, i_job.progress, &QProgressDialog::setValue);
+        connect(i_job.progress, &QProgressDialog::canceled,                    i_job.watcher,  &QFutureWatcher<QString>::cancel);
+    }
+    i_job.watcher->setFuture(future);
+    running_jobs_.insert(i_path, std::move(i_job));
+}
 
-    // If saving active & name changed, remove the previous save file
-    if (flag_name_changed)
+void MainWindow::FinishFileJob(const QString& i_path)
+{
+    if (!running_jobs_.contains(i_path)) return;
+    FileJob job = running_jobs_.take(i_path);
+    job.watcher->disconnect(this);
+    job.watcher->waitForFinished();
+    bool    cancelled = job.watcher->isCanceled();
+    QString error     = cancelled ? QString("Cancelled") : job.watcher->result();
+    job.watcher->deleteLater();
+    if (job.progress) job.progress->deleteLater();
+
+    // The list may have been closed while it was written
+    bool list_open = std::any_of(open_task_lists_.begin(), open_task_lists_.end(),
+                                 [&job](const TaskList::PtrUnique& i) { return i.get() == job.list; });
+
+    // Compaction: only drop the folded records from the journal once the new .dat file is in place
+    if (!job.snapshot)
     {
-        MainWindow::ConvertSpaceToUnderscore(stored_name);
-        QFile previous_file((task_list_dir_.path() + "\\" + stored_name + ".dat").toLocal8Bit());
-        if (!previous_file.remove())
+        if (error.isEmpty())
+            TaskJournal::Trim(TaskJournal::GetPath(i_path), job.journal_id, job.journal_end, &error);
+        if (error.isEmpty() && list_open)
+            UpdateManifest(i_path, job.list->GetTaskListName(), job.list->GetTaskListSize());
+        if (!error.isEmpty())
+            emit SignalStatus(QtWarningMsg, "Failed to compact the journal of \"" + i_path + "\": " + error);
+    }
+    // Export: a cancelled or failed export leaves any existing file as it was
+    else if (cancelled)
+        emit SignalStatus(QtInfoMsg, "Export of task list \"" + job.snapshot->name + "\" cancelled.");
+    // Save: on failure the file on disk is unchanged, so the list is dirty again and must be saved in full
+    else if (!error.isEmpty())
+    {
+        if (list_open && job.journal_id && job.list->GetJournalId() == job.journal_id)
+            job.list->SetJournalId(0);
+        if (list_open)
+            job.list->SetTaskListDirty();
+        ScheduleDisplay(kDisplayDirty);
+        emit SignalStatus(QtWarningMsg, "Failed to save task list \"" + job.snapshot->name + "\" to \"" + i_path + "\": " + error);
+    }
+    else
+    {
+        // If saving active & name changed, remove the previous save file and its journal
+        if (!job.previous_path.isEmpty())
         {
-            QString status = "Failed to remove \"" + stored_name + "\" from disk.";
-            emit SignalStatus(QtWarningMsg, status);
+            QFile::remove(TaskJournal::GetPath(job.previous_path));
+            QFile previous_file(job.previous_path.toLocal8Bit());
+            if (!previous_file.remove())
+            {
+                QString status = "Failed to remove \"" + job.previous_path + "\" from disk.";
+                emit SignalStatus(QtWarningMsg, status);
+            }
         }
+        if (job.journal_id)
+            UpdateManifest(i_path, job.snapshot->name, static_cast<uint32_t>(job.snapshot->tasks.size()));
+        QString status = QString("Successfully ") + (job.journal_id ? "saved" : "exported") + " task list \"" + job.snapshot->name + "\" to disk.";
+        emit SignalStatus(QtInfoMsg, status);
     }
 
-    // Return true to indicate a successful write
-    QString status = QString("Successfully ") + (i_save_type == TaskListSave::kExport ? "exported" : "saved") + " task list \"" + i_list->GetTaskListName() + "\" to disk.";
-    emit SignalStatus(QtInfoMsg, status);
+    // Start the save that waited for this one, if any
+    if (queued_saves_.contains(i_path))
+        StartFileJob(i_path, queued_saves_.take(i_path));
+}
+
+void MainWindow::WaitForFileJobs(const QString& i_path)
+{
+    while (running_jobs_.contains(i_path))
+        FinishFileJob(i_path);
+}
+
+bool MainWindow::IsSavePending(const QString& i_path) const
+{
+    return queued_saves_.contains(i_path) || (running_jobs_.contains(i_path) && running_jobs_.value(i_path).snapshot);
+}
+
+bool MainWindow::SelectCsvDivideField(char* o_divide_field)
+{
+    // Prompt the user for the desired field delineation (comma, tab, colon)
+    bool ok;
+    QStringList delineation_options;
+    delineation_options << tr("Comma") << tr("Tab")<< tr("Colon");
+    QString select_delineate = QInputDialog::getItem(this,
+                                                     tr("Select delineation character"),
+                                                     tr("Select delineation character for CSV export"),
+                                                     delineation_options,
+                                                     0,
+                                                     false,
+                                                     &ok);
+    if (!ok || select_delineate.isEmpty()) return false;
+
+    if     (select_delineate=="Tab")   *o_divide_field = '\t';
+    else if(select_delineate=="Colon") *o_divide_field = ':';
+    else                               *o_divide_field = ',';
     return true;
 }
 
@@ -598,109 +896,78 @@ bool MainWindow::LoadTaskListFromFile(QString i_file_name)
     else
         load_name = task_list_dir_.path() + "\\" + i_file_name;
 
-    // Opens, reads, and closes selected file; if file cannot be opened, exit function without loading
-    // Splits file into a list of byte arrays, delineated by DIVIDE_TASK
-    QFile load_file(load_name);
-    if (!load_file.open(QIODevice::ReadOnly))
+    // Read the file, then add the list to the open lists
+    // Lists in the Telos directory continue in their journal; imported files have none
+    TaskFileLoad load;
+    load.path = load_name;
+    load.Read(!i_file_name.isEmpty());
+    return AddLoadedTaskList(std::move(load), i_file_name.isEmpty());
+}
+
+bool MainWindow::ImportTaskListFromCsv(void)
+{
+    // Prompt user for file name/location; if cancel is clicked, exit without importing
+    QFileDialog dialog_load(nullptr);
+    dialog_load.setFileMode(QFileDialog::ExistingFile);
+    dialog_load.setNameFilter(tr("CSV Files (*.csv)"));
+    dialog_load.setViewMode(QFileDialog::Detail);
+    dialog_load.setAcceptMode(QFileDialog::AcceptOpen);
+    dialog_load.setDirectory(QDir::homePath());
+    if (!dialog_load.exec())
     {
-        emit SignalStatus(QtWarningMsg, "Failed to open task list \"" + load_name + "\" from disk.");
+        emit SignalStatus(QtWarningMsg, "Dialog exited: import aborted.");
         return false;
     }
-    QList<QByteArray> data_file = load_file.readAll().split(MainWindow::DIVIDE_TASK);
-    load_file.close();
-
-    // First item is incoming list name; if name is already in open lists, exit immediately
-    // Otherwise, create task list with that name; if name is already in list, exit immediately
-    QString list_name = QString::fromUtf8(data_file.first().toStdString());
-    data_file.pop_front();
-    if (IsDuplicateTaskListTitle(list_name))
+    QStringList selections = dialog_load.selectedFiles();
+    if (selections.empty())
     {
-        emit SignalStatus(QtWarningMsg, "Load aborted: File name already exists");
+        emit SignalStatus(QtWarningMsg, "Import aborted: No file selected.");
         return false;
     }
-    open_task_lists_.push_back(std::make_unique<TaskList>(list_name));
-    TaskList* o_list = open_task_lists_.back().get();
 
-    // *******************************************************************************************
-    // Task list with valid name should be successfully opened by this point
-    // Going forward, invalid inputs will result in logged errors, with unrecoverable data ignored
-    // *******************************************************************************************
-
-    // Persistent containers used to capture the incoming list of prereqs/depends for each task
-    // Memory addresses have not yet been assigned; all tasks must be in memory before assigning prereq/depend pointers
-    std::vector<QString>     i_names_all;
-    std::vector<QStringList> i_prereq_all, i_depend_all;
+    // Read the file, then add the list to the open lists, saving it into the Telos directory
+    TaskFileLoad load;
+    load.path = selections.first();
+    load.ReadCsv();
+    return AddLoadedTaskList(std::move(load), true);
+}
 
-    // Each remaining item is a task entry
-    // Iterate through each item, reading task information from each one
-    for (int i=0; i<data_file.size(); ++i)
+bool MainWindow::AddLoadedTaskList(TaskFileLoad&& i_load, bool i_imported)
+{
+    // Exit if the file couldn't be read
+    if (!i_load.list)
     {
-        // Temporary containers used to capture incoming task information used in task constructor
-        // Released/reset with each iteration
-        uint8_t     i_byte;
-        QString     i_name,     i_description;
-        QDateTime   i_deadline, i_completed;
-        QStringList i_prereq,   i_depend;
-
-        // Split current task entry into constituent fields
-        QList<QByteArray> data_task = data_file[i].split(MainWindow::DIVIDE_FIELD);
-
-        // Task name: Add to a container for later use in assigning prerequisites
-        i_name = QString::fromUtf8(data_task[0].toStdString());
-        i_names_all.push_back(i_name);
-
-        // Task description: EMPTY byte indicates no description
-        i_byte = data_task[1].at(0);
-        if (i_byte == MainWindow::EMPTY) i_description = "";
-        else i_description = QString::fromUtf8(data_task[1].toStdString());
-
-        // Task deadline: EMPTY byte indicates no deadline
-        i_byte = data_task[2].at(0);
-        if (i_byte == MainWindow::EMPTY) i_deadline = QDateTime();
-        else i_deadline = QDateTime::fromString(QString::fromUtf8(data_task[2].toStdString()));
-
-        // Task completed: EMPTY byte indicates not completed
-        i_byte = data_task[3].at(0);
-        if (i_byte == MainWindow::EMPTY) i_completed = QDateTime();
-        else i_completed = QDateTime::fromString(QString::fromUtf8(data_task[3].toStdString()));
-
-        // Task prerequisites: EMPTY byte indicates no prerequisites
-        // Divide prerequsites by DIVIDE_SUBFIELD, push each task prerequisite into a string list
-        // Push final string list into a list of prerequisites for all tasks, to be turned into pointers later
-        i_byte = data_task[4].at(0);
-        if (i_byte != MainWindow::EMPTY)
-        {
-            QList<QByteArray> data_prereq = data_task[4].split(MainWindow::DIVIDE_SUBFIELD);
-            for (int j=0; j<data_prereq.size(); ++j)
-                i_prereq.push_back(QString::fromUtf8(data_prereq[j].toStdString()));
-        }
-        i_prereq_all.push_back(i_prereq);
-
-        // Task dependents: EMPTY byte indicates no dependents
-        // Divide dependents by DIVIDE_SUBFIELD, push each task dependent into a string list
-        // Push final string list into a list of dependents for all tasks, to be turned into pointers later
-        i_byte = data_task[5].at(0);
-        if (i_byte != MainWindow::EMPTY)
-        {
-            QList<QByteArray> data_depend = data_task[5].split(MainWindow::DIVIDE_SUBFIELD);
-            for (int j=0; j<data_depend.size(); ++j)
-                i_depend.push_back(QString::fromUtf8(data_depend[j].toStdString()));
-        }
-        i_depend_all.push_back(i_depend);
-
-        // Construct task object with collected information, and add to task list
-        o_list->AddTaskToList(i_name, i_description, i_deadline, i_completed);
+        emit SignalStatus(QtWarningMsg, "Load aborted: \"" + i_load.path + "\": " + i_load.error + ".");
+        return false;
     }
 
-    // Iterate through all tasks in list, adding prerequisites/dependents to each
-    for(int i=0; i<i_names_all.size(); ++i)
+    // If name is already in open lists, exit immediately
+    // A manifest entry for the file being loaded is the list itself, not a duplicate
+    QString                        list_name = i_load.list->GetTaskListName();
+    const TaskListManifest::Entry* entry     = manifest_.FindList(list_name);
+    bool                           own_entry = !i_imported && entry && task_list_dir_.path() + "\\" + entry->file_name == i_load.path;
+    bool                           duplicate = entry && !own_entry;
+    for (size_t i=0; i<open_task_lists_.size() && !duplicate; ++i)
+        duplicate = open_task_lists_[i]->GetTaskListName() == list_name;
+    if (duplicate)
     {
-        o_list->SetTaskPrereqFromList(i_names_all[i], i_prereq_all[i]);
-        o_list->SetTaskDependFromList(i_names_all[i], i_depend_all[i]);
+        emit SignalStatus(QtWarningMsg, "Load aborted: File name already exists");
+        return false;
     }
+    open_task_lists_.push_back(std::move(i_load.list));
+    TaskList* o_list = open_task_lists_.back().get();
+    o_list->SetChangeLogging(true);
+    list_last_used_.insert(o_list, QDateTime::currentMSecsSinceEpoch());
+    if (!i_imported)
+        UpdateManifest(i_load.path, list_name, o_list->GetTaskListSize());
+
+    // Task list with valid name should be successfully opened by this point
+    // Report any records which could not be read
+    for (const QString& i : i_load.warnings)
+        emit SignalStatus(QtWarningMsg, i);
 
     // If file was imported, save to disk immediately
-    if (i_file_name.isEmpty())
+    if (i_imported)
         SaveTaskListToFile(o_list, TaskListSave::kNew);
 
     // Return true to indicate successful load
@@ -709,13 +976,6 @@ bool MainWindow::LoadTaskListFromFile(QString i_file_name)
     return true;
 }
 
-void MainWindow::ConvertToDoubleQuotes(QString &i_string)
-{
-    for (int i=0; i<i_string.size(); ++i)
-        if (i_string[i] == '\"')
-            i_string.insert(i++, '\"');
-}
-
 bool MainWindow::eventFilter(QObject *watched, QEvent *event)
 {
     if (watched != ui->menubar)
@@ -734,22 +994,75 @@ bool MainWindow::eventFilter(QObject *watched, QEvent *event)
     return false;
 }
 
+void MainWindow::ScheduleDisplay(uint8_t i_panes)
+{
+    // Panes already covered by the rendering in progress are rendered after this by it (a model reset during
+    // UpdateDisplayActiveTaskList() marks the active task, say); the first pane marked queues the rendering
+    i_panes &= ~display_rendering_;
+    if (!i_panes) return;
+    if (!display_pending_)
+        QMetaObject::invokeMethod(this, &MainWindow::UpdateDisplay, Qt::QueuedConnection);
+    display_pending_ |= i_panes;
+}
+
+void MainWindow::UpdateDisplay(void)
+{
+    // Render the widest pane marked, which renders those below it
+    // Queued calls are delivered before input waiting in the window system, so no slot sees the panes out of date
+    uint8_t panes = std::exchange(display_pending_, kDisplayNone);
+    if (panes & kDisplayOpenLists)
+    {
+        display_rendering_ = kDisplayOpenLists | kDisplayActiveList | kDisplayActiveTask | kDisplayDirty;
+        UpdateDisplayOpenTaskLists();
+    }
+    else if (panes & kDisplayActiveList)
+    {
+        display_rendering_ = kDisplayActiveList | kDisplayActiveTask | kDisplayDirty;
+        UpdateDisplayActiveTaskList();
+    }
+    else
+    {
+        display_rendering_ = panes;
+        if (panes & kDisplayActiveTask) UpdateDisplayActiveTask();
+        if (panes & kDisplayDirty)      UpdateDisplayDirty();
+    }
+    display_rendering_ = kDisplayNone;
+}
+
 void MainWindow::UpdateDisplayOpenTaskLists(void)
 {
-    // Set the active task list to the selected list
+    // Set the active task list to the selected list, loading it if it hasn't been yet, then drop lists gone unused
+    // The list switched away from counts as used, as well as the one selected
     QListWidgetItem* selected_item = ui->lwOpenTaskLists->currentItem();
+    TaskList*        previous_list = active_task_list_;
+    qint64           now           = QDateTime::currentMSecsSinceEpoch();
     active_task_list_ = selected_item ? GetOpenTaskListPtr(selected_item->text()) : nullptr;
+    if (previous_list)     list_last_used_.insert(previous_list,     now);
+    if (active_task_list_) list_last_used_.insert(active_task_list_, now);
+    EvictIdleTaskLists();
 
-    // Get names of all open lists, then sorts the list
+    // Get names of all open lists, loaded or only in the manifest, then sorts the list
     QStringList open_task_list_names = QStringList();
     if (!open_task_lists_.empty())
         for(int i=0; i<open_task_lists_.size(); ++i)
             open_task_list_names.push_back(open_task_lists_[i]->GetTaskListName());
+    for (const TaskListManifest::Entry& i : manifest_.GetEntries())
+        if (!open_task_list_names.contains(i.list_name))
+            open_task_list_names.push_back(i.list_name);
     std::sort(open_task_list_names.begin(), open_task_list_names.end(), [](QString left, QString right) {return left < right;});
 
     // Clear any displayed task lists, and then adds back the sorted open list names
+    // Lists in the manifest show their task count and when they were last saved
     ui->lwOpenTaskLists->clear();
     ui->lwOpenTaskLists->addItems(open_task_list_names);
+    for (int i=0; i<ui->lwOpenTaskLists->count(); ++i)
+    {
+        QListWidgetItem*               item  = ui->lwOpenTaskLists->item(i);
+        const TaskListManifest::Entry* entry = manifest_.FindList(item->text());
+        if (entry)
+            item->setToolTip(QString::number(entry->task_count) + " task(s), saved "
+                             + QDateTime::fromMSecsSinceEpoch(std::max(entry->file_time, entry->journal_time)).toString());
+    }
 
     // If a task list was previously active, re-select it if still in list
     // If it is no longer in the list, set active task list to null ptr
@@ -771,65 +1084,32 @@ void MainWindow::UpdateDisplayActiveTaskList(void)
     // Display active task list title and enables/disables field
     UpdateDisplayText(active_task_list_, active_task_list_ ? active_task_list_->GetTaskListName() : "No task list selected", ui->teTitleTaskList);
 
-    // Iterate through all tasks, and add individual tasks to filtered list per active filter
-    QStringList filtered_tasks;
-    if (active_task_list_)
-    {
-        for(int i=0; i<active_task_list_->GetTaskListSize(); ++i)
-        {
-            Task* my_task_ptr = (*active_task_list_)[i];
-            if (active_filter_ == TaskFilter::kAll                                                                                        // TaskFilter::all       - Add all tasks to filtered list (so, y'know, don't filter it)
-            || (active_filter_ == TaskFilter::kCompleted && my_task_ptr->IsTaskComplete())                                                    // TaskFilter::completed - Add task to filtered list if complete
-            || (active_filter_ == TaskFilter::kCurrent   && !(my_task_ptr->IsTaskComplete()) && my_task_ptr->AreTaskPrereqComplete())      // TaskFilter::current   - Add task to filtered list if task is incomplete, but all prerequisites are complete
-            || (active_filter_ == TaskFilter::kPending   && !(my_task_ptr->IsTaskComplete()) && !(my_task_ptr->AreTaskPrereqComplete())))  // TaskFilter::pending   - Add task to filtered list if task is incomplete, and any prerequisites are incomplete
-                filtered_tasks.append(my_task_ptr->GetTaskName());
-        }
-    }
+    // Show the active list's tasks per active filter and sort; the view only builds the rows it displays
+    // The rows follow edits to the list as they're made, so they're only rebuilt when the list, filter or sort change
+    task_list_model_->SetTasks(active_task_list_, active_filter_, active_sort_);
 
-    // Create a stack of sorts to perform based on the active sort
-    std::vector<TaskSort> sorting_stack;
-    if (active_sort_ == TaskSort::kName)
-    {
-        sorting_stack.push_back(TaskSort::kName);
-        sorting_stack.push_back(TaskSort::kDeadline);
-    }
-    else if (active_sort_ == TaskSort::kDeadline)
-    {
-        sorting_stack.push_back(TaskSort::kDeadline);
-        sorting_stack.push_back(TaskSort::kName);
-    }
+    SelectActiveTask();
 
-    // Sort filtered tasks in stack order
-    while (!sorting_stack.empty())
-    {
-        TaskSort current_sort = sorting_stack.back();
-        sorting_stack.pop_back();
-        if      (current_sort == TaskSort::kName)
-            std::sort(filtered_tasks.begin(), filtered_tasks.end(), [](QString left, QString right) {return left < right;});
-        else if (current_sort == TaskSort::kDeadline)
-            std::sort(filtered_tasks.begin(), filtered_tasks.end(), [this](QString left, QString right) {return active_task_list_->GetPtrFromTaskList(left)->GetTaskDeadline() < active_task_list_->GetPtrFromTaskList(right)->GetTaskDeadline();});
-    }
+    // Enable task creation if a list is active
+    ui->pbCreateTask->setEnabled(active_task_list_);
+    UpdateDisplayDirty();
 
-    // Clear the displayed task list, adds sorted and filtered tasks
-    ui->lwTaskList->clear();
-    ui->lwTaskList->addItems(filtered_tasks);
+    // Update the active task information
+    UpdateDisplayActiveTask();
+}
 
+void MainWindow::SelectActiveTask(void)
+{
     // If a task was previously active, re-select it if still in list
     // If it is no longer in the list, set active task to null ptr
     if (active_task_)
     {
-        QList<QListWidgetItem *> active_item = ui->lwTaskList->findItems(active_task_->GetTaskName(), Qt::MatchExactly);
-        if (!active_item.empty())
-            ui->lwTaskList->setCurrentItem(active_item.first());
+        int active_row = task_list_model_->GetRow(active_task_);
+        if (active_row >= 0)
+            ui->lvTaskList->setCurrentIndex(task_list_model_->index(active_row));
         else
             active_task_ = nullptr;
     }
-
-    // Enable task creation if a list is active
-    ui->pbCreateTask->setEnabled(active_task_list_);
-
-    // Update the active task information
-    UpdateDisplayActiveTask();
 }
 
 void MainWindow::UpdateDisplayActiveTask(void)
@@ -856,8 +1136,23 @@ void MainWindow::UpdateDisplayActiveTask(void)
     ui->pbUnlinkPrerequisite ->setEnabled(active_task_);
 }
 
+void MainWindow::UpdateDisplayDirty(void)
+{
+    // Only loaded lists can have unsaved changes; rows of the active list are repainted by its view
+    for (int i=0; i<ui->lwOpenTaskLists->count(); ++i)
+    {
+        QListWidgetItem* item = ui->lwOpenTaskLists->item(i);
+        auto             list = std::find_if(open_task_lists_.begin(), open_task_lists_.end(),
+                                             [item](const TaskList::PtrUnique& i_list) { return i_list->GetTaskListName() == item->text(); });
+        QFont            font = item->font();
+        font.setItalic(list != open_task_lists_.end() && (*list)->IsTaskListDirty());
+        item->setFont(font);
+    }
+    task_list_model_->UpdateDirty();
+}
+
 void MainWindow::UpdateDisplayText(bool            i_enable,
-                                   QString         i_text,
+                                   const QString&  i_text,
                                    QPlainTextEdit* i_text_edit)
 {
     // Enable/disable the field and sets contents to input value
@@ -865,24 +1160,22 @@ void MainWindow::UpdateDisplayText(bool            i_enable,
     i_text_edit->setPlainText(i_text);
 }
 
-void MainWindow::UpdateDisplayCombo(bool               i_enable,
-                                    Task::PtrVector    i_list,
-                                    QComboBox*         i_combo_box,
-                                    QStringListModel*  i_model)
+void MainWindow::UpdateDisplayCombo(bool                   i_enable,
+                                    const Task::PtrVector& i_list,
+                                    QComboBox*             i_combo_box,
+                                    QStringListModel*      i_model)
 {
     // Enable/disable the field
     i_combo_box->setEnabled(i_enable);
 
     // Create a string list of all input task names, then set the combo model with them
-    QStringList updated_list;
-    for (Task *i : i_list) updated_list.push_back(i->GetTaskName());
-    i_model->setStringList(updated_list);
+    i_model->setStringList(Task::GetTaskNames(i_list));
 }
 
-void MainWindow::UpdateDisplayDateTimeSaved(bool           i_enable,
-                                            QDateTime      i_date_time,
-                                            QCheckBox*     i_check_box,
-                                            QDateTimeEdit* i_date_time_edit)
+void MainWindow::UpdateDisplayDateTimeSaved(bool             i_enable,
+                                            const QDateTime& i_date_time,
+                                            QCheckBox*       i_check_box,
+                                            QDateTimeEdit*   i_date_time_edit)
 {
     // Enable/disable the check box associated with the DateTime field
     i_check_box->setEnabled(i_enable);
@@ -902,9 +1195,9 @@ void MainWindow::UpdateDisplayDateTimeSaved(bool           i_enable,
     }
 }
 
-void MainWindow::UpdateDisplayDateTimeCurrent(QDateTime      i_time,
-                                              QCheckBox*     i_check_box,
-                                              QDateTimeEdit* i_date_time_edit)
+void MainWindow::UpdateDisplayDateTimeCurrent(const QDateTime& i_time,
+                                              QCheckBox*       i_check_box,
+                                              QDateTimeEdit*   i_date_time_edit)
 {
     // Show/hide the DateTime field in accordance with associated checkbox
     // Initialize it to the current DateTime if one isn't already saved
@@ -950,8 +1243,8 @@ bool MainWindow::IsDuplicateTaskListTitle(QString i_name)
     if (i_name.isEmpty())
         i_name = ui->teTitleTaskList->toPlainText();
 
-    // Searches open lists for input name
-    bool found = false;
+    // Searches open lists for input name, including those not loaded yet
+    bool found = manifest_.FindList(i_name) != nullptr;
     for (int i=0; i<open_task_lists_.size() && !found; ++i)
         if (open_task_lists_[i]->GetTaskListName() == i_name)
             found = true;
@@ -972,7 +1265,12 @@ void MainWindow::PromptSaveTask(void)
 
 void MainWindow::PromptSaveTaskList(void)
 {
-    if (!list_changed_) return;
+    if (!active_task_list_ || !active_task_list_->IsTaskListDirty()) return;
+    if (autosave_)
+    {
+        SaveTaskListToFile(active_task_list_, TaskListSave::kActive);
+        return;
+    }
     QMessageBox::StandardButton reply = QMessageBox::question(this,
                                                               "Save List?",
                                                               "Save changes to the current list?",
@@ -980,6 +1278,15 @@ void MainWindow::PromptSaveTaskList(void)
     if (reply == QMessageBox::Save) SaveTaskListToFile(active_task_list_, TaskListSave::kActive);
 }
 
+void MainWindow::AutosaveTaskLists(void)
+{
+    // Each dirty list appends its changes to its journal, or is written in the background if it needs a full save
+    for (const TaskList::PtrUnique& i : open_task_lists_)
+        if (i->IsTaskListDirty())
+            SaveTaskListToFile(i.get(), TaskListSave::kAuto);
+    ScheduleDisplay(kDisplayDirty);
+}
+
 void MainWindow::SlotStatus(QtMsgType i_type, QString i_message)
 {
     ui->teStatusBar->setPlainText(i_message);
@@ -1031,5 +1338,6 @@ void MainWindow::on_actionClearCompleted_triggered()
                                                               QMessageBox::Save|QMessageBox::Discard);
     if (reply == QMessageBox::Save) SaveTaskListToFile(active_task_list_, TaskListSave::kCompleted);
     active_task_list_->RemoveTasksFromList(active_task_list_->GetAllCompleted());
-    UpdateDisplayActiveTaskList();
+    ScheduleAutosave();
+    ScheduleDisplay(kDisplayActiveList);
 }
@@ -24,20 +24,22 @@
 
 #include "dialogtaskselect.h"
 #include "task.h"
+#include "taskfile.h"
+#include "tasklistmodel.h"
 
+#include <QtConcurrent>
 #include <QtGui>
 #include <QFileDialog>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
 #include <QInputDialog>
 #include <QMessageBox>
+#include <QProgressDialog>
+#include <QSettings>
+#include <QTimer>
 
-// Selected filter
-enum class TaskFilter {kCurrent, kCompleted, kPending, kAll};
-
-// Sorting options
-enum class TaskSort {kName, kDeadline};
-
-// Save options
-enum class TaskListSave {kNew, kActive, kExport, kCSV, kCompleted};
+// Save options (kAuto saves a list under its own name, as autosave does)
+enum class TaskListSave {kNew, kActive, kAuto, kExport, kCSV, kCompleted};
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -53,10 +55,11 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
-    static constexpr uint8_t EMPTY           = 0;
-    static constexpr uint8_t DIVIDE_FIELD    = 1;
-    static constexpr uint8_t DIVIDE_SUBFIELD = 2;
-    static constexpr uint8_t DIVIDE_TASK     = 3;
+    // .dat delimiter bytes, defined by the file reader
+    static constexpr uint8_t EMPTY           = TaskFileReader::EMPTY;
+    static constexpr uint8_t DIVIDE_FIELD    = TaskFileReader::DIVIDE_FIELD;
+    static constexpr uint8_t DIVIDE_SUBFIELD = TaskFileReader::DIVIDE_SUBFIELD;
+    static constexpr uint8_t DIVIDE_TASK     = TaskFileReader::DIVIDE_TASK;
 
 private:
 
@@ -72,9 +75,57 @@ private:
     QPoint                                 drag_position_;
     std::unique_ptr<QStringListModel>      prereq_combo_box_;
     std::unique_ptr<QStringListModel>      depend_combo_box_;
-    bool                                   list_changed_;
+    std::unique_ptr<TaskListModel>         task_list_model_;   // Rows of lvTaskList
     QDir                                   task_list_dir_;
     bool                                   debug_mode_;
+    bool                                   compress_lists_;  // Save lists in the Telos directory compressed (a saved setting)
+
+    // Background writes of files, by path: a save or CSV export (of a snapshot) or a journal compaction runs on a
+    // worker thread, and at most one more save waits behind it - a newer save replaces the waiting one
+    struct FileJob
+    {
+        QFutureWatcher<QString>*                watcher;        // Set once the job is running
+        TaskList*                               list;
+        std::shared_ptr<const TaskListSnapshot> snapshot;       // Contents to save; null for a compaction
+        uint64_t                                journal_id;
+        uint64_t                                journal_end;    // Journal offset folded in by a compaction
+        QString                                 previous_path;  // File to remove once saved (list was renamed)
+        TaskListSave                            save_type;
+        char                                    csv_divide_field = ',';      // Field separator of a CSV export
+        QProgressDialog*                        progress         = nullptr;  // Shown while a CSV export runs
+    };
+    QHash<QString, FileJob>                running_jobs_;
+    QHash<QString, FileJob>                queued_saves_;
+
+    // Every list in the Telos directory, loaded when first selected; saved lists unused for LIST_EVICT_MSECS are dropped
+    TaskListManifest                       manifest_;
+    QHash<const TaskList*, qint64>         list_last_used_;
+    static constexpr qint64                LIST_EVICT_MSECS = 15 * 60 * 1000;
+
+    // Changes made to the Telos directory elsewhere (another Telos, a script) are applied once it has been quiet
+    // for RELOAD_DELAY_MSECS; files that still match the manifest, such as those just saved here, are skipped
+    QFileSystemWatcher                     dir_watcher_;
+    QTimer                                 reload_timer_;
+    static constexpr int                   RELOAD_DELAY_MSECS = 500;
+
+    // With autosave on (a saved setting), edits restart autosave_timer_, and once none have been made for the delay
+    // every list with unsaved changes is saved; a burst of edits to a list is written as one save
+    bool                                   autosave_;
+    QTimer                                 autosave_timer_;
+    static constexpr int                   AUTOSAVE_DELAY_SECS = 5;  // Default delay
+
+    // Panes of the window to redisplay; slots mark the panes their changes affect, and every pane marked during
+    // an event is rendered once when it's done, so a pane marked again (or covered by a wider one) isn't rebuilt twice
+    enum DisplayPane : uint8_t
+    {
+        kDisplayNone       = 0,
+        kDisplayOpenLists  = 1 << 0,  // Open task lists, then everything below
+        kDisplayActiveList = 1 << 1,  // Active task list and its tasks, then the active task and italics
+        kDisplayActiveTask = 1 << 2,  // Fields of the active task
+        kDisplayDirty      = 1 << 3   // Italics of lists and tasks with unsaved changes
+    };
+    uint8_t                                display_pending_;    // Panes marked, not rendered yet
+    uint8_t                                display_rendering_;  // Panes covered by the rendering in progress
 
     // Accessors - Returns saved information for the selected task & task list
     // Returns empty QString/QDateTime/std::vector if no task/list is active
@@ -83,24 +134,42 @@ private:
     QString            GetActiveTaskDescription (void) { return active_task_      ? active_task_->      GetTaskDescription() : QString();            }
     QDateTime          GetActiveTaskDeadline    (void) { return active_task_      ? active_task_->      GetTaskDeadline()    : QDateTime();          }
     QDateTime          GetActiveTaskCompleted   (void) { return active_task_      ? active_task_->      GetTaskCompleted()   : QDateTime();          }
-    std::vector<Task*> GetActiveTaskPrereqSaved (void) { return active_task_      ? active_task_->      GetTaskPrereq()      : std::vector<Task*>(); }
-    std::vector<Task*> GetActiveTaskDependSaved (void) { return active_task_      ? active_task_->      GetTaskDepend()      : std::vector<Task*>(); }
+    std::vector<Task*> GetActiveTaskPrereqSaved (void) { return active_task_      ? active_task_list_-> GetTaskPrereq(active_task_) : std::vector<Task*>(); }
+    std::vector<Task*> GetActiveTaskDependSaved (void) { return active_task_      ? active_task_list_-> GetTaskDepend(active_task_) : std::vector<Task*>(); }
     QString            GetActiveTaskListName    (void) { return active_task_list_ ? active_task_list_-> GetTaskListName()    : QString();            }
 
-    //
+    // GetOpenTaskListPtr() loads the list if it's in the manifest but not loaded yet
     TaskList* GetOpenTaskListPtr (QString i_name);
     Task*     GetSelectedTask    (void);
 
+    // GetTaskListFileName()
+    // Name of the file a list is saved in within the Telos directory (spaces become underscores)
+    static QString GetTaskListFileName (QString i_name) { ConvertSpaceToUnderscore(i_name); return i_name + ".dat"; }
+
+    // UpdateManifest(), EvictIdleTaskLists()
+    // Record a list as saved in a file of the Telos directory; drop loaded lists that have gone unused (see manifest_)
+    void UpdateManifest     (const QString& i_path, const QString& i_list_name, uint32_t i_task_count);
+    void EvictIdleTaskLists (void);
+
+    // ReleaseFileBuffer()
+    // Let a list go of the file it was loaded from, warning if any descriptions couldn't be read from it
+    void ReleaseFileBuffer (TaskList*);
+
+    // WatchTaskListDir(), ReloadChangedTaskLists()
+    // Watch the Telos directory; bring lists up to date with files changed elsewhere, unless they have unsaved changes
+    void WatchTaskListDir       (void);
+    void ReloadChangedTaskLists (void);
+
     // ********
     // Mutators
     // ********
 
     // Save information for the active task
     // Return false if no task is active, otherwise true
-    void SetActiveTaskName        (QString i_name)                     { if (active_task_) active_task_->SetTaskName       (i_name);                             }
-    void SetActiveTaskDescription (QString i_description)              { if (active_task_) active_task_->SetTaskDescription(i_description);                      }
-    void SetActiveTaskDeadline    (bool i_flag, QDateTime i_date_time) { if (active_task_) active_task_->SetTaskDeadline   (i_flag ? i_date_time : QDateTime()); }
-    void SetActiveTaskCompleted   (bool i_flag, QDateTime i_date_time) { if (active_task_) active_task_->SetTaskCompleted  (i_flag ? i_date_time : QDateTime()); }
+    void SetActiveTaskName        (QString i_name)                     { if (active_task_) active_task_list_->SetTaskName  (active_task_, i_name);               }
+    void SetActiveTaskDescription (QString i_description)              { if (active_task_) active_task_list_->SetTaskDescription(active_task_, i_description);          }
+    void SetActiveTaskDeadline    (bool i_flag, QDateTime i_date_time) { if (active_task_) active_task_list_->SetTaskDeadline   (active_task_, i_flag ? i_date_time : QDateTime()); }
+    void SetActiveTaskCompleted   (bool i_flag, QDateTime i_date_time) { if (active_task_) active_task_list_->SetTaskCompleted(active_task_, i_flag ? i_date_time : QDateTime()); }
 
     //
     void SelectPrereqToChange (TaskSelection);
@@ -117,12 +186,42 @@ private:
     bool SaveTaskListToFile   (TaskList*, TaskListSave);
     bool LoadTaskListFromFile (QString = QString());
 
+    // ImportTaskListFromCsv()
+    // Prompts for a CSV file (see TaskFileCsv::ReadFile()) and imports it as a new list
+    bool ImportTaskListFromCsv (void);
+
+    // AddLoadedTaskList()
+    // Add a list read from a file to the open lists, reporting any problems reading it
+    // Imported lists are saved into the Telos directory; returns false if the list couldn't be added
+    bool AddLoadedTaskList    (TaskFileLoad&&, bool i_imported);
+
+    // AppendTaskListJournal()
+    // Save a list's logged changes to the journal of its .dat file; false if it can't, so the whole list is saved instead
+    bool AppendTaskListJournal (TaskList*, const QString& i_file_path);
+
+    // QueueSave(), StartCompaction()
+    // Write a list to a file, or fold a file's journal into it, on a worker thread once the file's previous write is done
+    void QueueSave       (TaskList*, const QString& i_path, TaskListSave, uint64_t i_journal_id,
+                          const QString& i_previous_path = QString(), char i_csv_divide_field = ',');
+    void StartCompaction (TaskList*, const QString& i_path, uint64_t i_journal_end);
+
+    // StartFileJob(), FinishFileJob(), WaitForFileJobs(), IsSavePending()
+    // Run a background write; report a finished one and start the next; wait until a file has none left;
+    // check for a save running or waiting
+    void StartFileJob    (const QString& i_path, FileJob);
+    void FinishFileJob   (const QString& i_path);
+    void WaitForFileJobs (const QString& i_path);
+    bool IsSavePending   (const QString& i_path) const;
+
+    // SelectCsvDivideField()
+    // Prompts for a CSV field delineator (comma, tab, colon); returns false if the prompt was cancelled
+    bool SelectCsvDivideField (char* o_divide_field);
+
     // ******
     // Static
     // ******
 
     static void ConvertSpaceToUnderscore(QString &i_name) { while (i_name.indexOf(' ') != -1) i_name.replace(i_name.indexOf(' '), 1, '_'); }
-    static void ConvertToDoubleQuotes(QString&);
 
     // *********
     // Interface
@@ -131,17 +230,28 @@ private:
     // Move window if menu bar is clicked & dragged
     bool eventFilter (QObject*, QEvent*);
 
+    // ScheduleDisplay(), UpdateDisplay()
+    // Mark panes to redisplay (see DisplayPane); they're rendered once the current event is handled
+    void ScheduleDisplay (uint8_t i_panes);
+    void UpdateDisplay   (void);
+
     // Update open task lists, active list, or active task
-    // Each of these functions calls the one below it after finishing
+    // Each of these functions calls the one below it after finishing; slots call ScheduleDisplay() instead
     void UpdateDisplayOpenTaskLists  (void);
     void UpdateDisplayActiveTaskList (void);
     void UpdateDisplayActiveTask     (void);
 
+    // Show lists and tasks with unsaved changes in italics, without redisplaying anything else
+    void UpdateDisplayDirty (void);
+
+    // Re-select the active task in the task view, or clear it if the view no longer shows it
+    void SelectActiveTask (void);
+
     // Updates individual fields with input data
-    void UpdateDisplayText            (bool,      QString,            QPlainTextEdit*                   );
-    void UpdateDisplayCombo           (bool,      std::vector<Task*>, QComboBox*,     QStringListModel* );
-    void UpdateDisplayDateTimeSaved   (bool,      QDateTime,          QCheckBox*,     QDateTimeEdit*    );
-    void UpdateDisplayDateTimeCurrent (QDateTime, QCheckBox*,         QDateTimeEdit*                    );
+    void UpdateDisplayText            (bool,             const QString&,            QPlainTextEdit*                   );
+    void UpdateDisplayCombo           (bool,             const std::vector<Task*>&, QComboBox*,     QStringListModel* );
+    void UpdateDisplayDateTimeSaved   (bool,             const QDateTime&,          QCheckBox*,     QDateTimeEdit*    );
+    void UpdateDisplayDateTimeCurrent (const QDateTime&, QCheckBox*,                QDateTimeEdit*                    );
 
     // ValidateTaskListTitle()
     // Empty input string checks the user input, otherwise checks validity of input string
@@ -149,8 +259,17 @@ private:
     bool IsValidTaskListTitle    (QString = QString());
     bool IsDuplicateTaskListTitle(QString = QString());
 
+    // ScheduleAutosave(), AutosaveTaskLists()
+    // Call ScheduleAutosave() after each edit of the active list; AutosaveTaskLists() saves every list with unsaved changes
+    void ScheduleAutosave  (void)
+    {
+        if (active_task_list_) list_last_used_.insert(active_task_list_, QDateTime::currentMSecsSinceEpoch());
+        if (autosave_) autosave_timer_.start();
+    }
+    void AutosaveTaskLists (void);
+
     // PromptSaveTask(), PromptSaveTaskList()
-    // If there are unsaved changes to the task/list, prompts the user to save them
+    // If there are unsaved changes to the task/list, prompts the user to save them (lists are saved without asking if autosaving)
     // If no unsaved changes, does nothing
     void PromptSaveTask(void);
     void PromptSaveTaskList(void);
@@ -168,25 +287,31 @@ private slots:
     void on_actionCreateList_triggered(void)
     {
         CreateTaskList();
-        UpdateDisplayOpenTaskLists();
+        ScheduleDisplay(kDisplayOpenLists);
     }
 
     void on_actionSaveList_triggered(void)
     {
         SaveTaskListToFile(active_task_list_, TaskListSave::kActive);
-        UpdateDisplayOpenTaskLists();
+        ScheduleDisplay(kDisplayOpenLists);
     }
 
     void on_actionRemoveList_triggered()
     {
         RemoveTaskList(active_task_list_);
-        UpdateDisplayOpenTaskLists();
+        ScheduleDisplay(kDisplayOpenLists);
     }
 
     void on_actionImportList_triggered(void)
     {
         if(!LoadTaskListFromFile()) return;
-        UpdateDisplayOpenTaskLists();
+        ScheduleDisplay(kDisplayOpenLists);
+    }
+
+    void on_actionImportCSV_triggered(void)
+    {
+        if(!ImportTaskListFromCsv()) return;
+        ScheduleDisplay(kDisplayOpenLists);
     }
 
     void on_actionExportList_triggered(void)
@@ -203,6 +328,30 @@ private slots:
         SaveTaskListToFile(active_task_list_, TaskListSave::kCSV);
     }
 
+    void on_actionCompressLists_toggled(bool i_checked)
+    {
+        compress_lists_ = i_checked;
+        QSettings("Cynical Tech Humor", "Telos").setValue("CompressLists", i_checked);
+    }
+
+    void on_actionAutosave_toggled(bool i_checked)
+    {
+        autosave_ = i_checked;
+        QSettings("Cynical Tech Humor", "Telos").setValue("Autosave", i_checked);
+        if (autosave_) AutosaveTaskLists();
+        else           autosave_timer_.stop();
+    }
+
+    void on_actionAutosaveDelay_triggered(void)
+    {
+        bool flag_ok = false;
+        int  delay   = QInputDialog::getInt(this, "Autosave Delay", "Seconds without edits before saving:",
+                                            autosave_timer_.interval() / 1000, 1, 3600, 1, &flag_ok);
+        if (!flag_ok) return;
+        autosave_timer_.setInterval(delay * 1000);
+        QSettings("Cynical Tech Humor", "Telos").setValue("AutosaveDelaySecs", delay);
+    }
+
     void on_menuQuit_triggered(void)
     {
         PromptSaveTask();
@@ -214,13 +363,13 @@ private slots:
     {
         PromptSaveTask();
         PromptSaveTaskList();
-        UpdateDisplayOpenTaskLists();
+        ScheduleDisplay(kDisplayOpenLists);
     }
 
-    void on_lwTaskList_itemClicked(QListWidgetItem *item)
+    void on_lvTaskList_clicked(const QModelIndex& index)
     {
         PromptSaveTask();
-        UpdateDisplayActiveTask();
+        ScheduleDisplay(kDisplayActiveTask);
     }
 
     void on_pbToggleShowOpenTaskLists_clicked(void)
@@ -232,13 +381,13 @@ private slots:
     void on_pbCreateTask_clicked(void)
     {
         CreateTask();
-        UpdateDisplayActiveTaskList();
+        ScheduleDisplay(kDisplayActiveList);
     }
 
     void on_pbRemoveTask_clicked(void)
     {
         RemoveTask();
-        UpdateDisplayActiveTaskList();
+        ScheduleDisplay(kDisplayActiveList);
     }
 
     void on_pbLinkPrerequisite_clicked(void)
@@ -254,7 +403,7 @@ private slots:
     void on_pbSaveChanges_clicked(void)
     {
         SaveActiveTask();
-        UpdateDisplayActiveTaskList();
+        ScheduleDisplay(kDisplayActiveList);
     }
 
     void on_teTitleTaskList_textChanged(void)
@@ -307,37 +456,37 @@ private slots:
     void on_rbCurrent_clicked(void)
     {
         active_filter_ = TaskFilter::kCurrent;
-        UpdateDisplayActiveTaskList();
+        ScheduleDisplay(kDisplayActiveList);
     }
 
     void on_rbPending_clicked(void)
     {
         active_filter_ = TaskFilter::kPending;
-        UpdateDisplayActiveTaskList();
+        ScheduleDisplay(kDisplayActiveList);
     }
 
     void on_rbCompleted_clicked(void)
     {
         active_filter_ = TaskFilter::kCompleted;
-        UpdateDisplayActiveTaskList();
+        ScheduleDisplay(kDisplayActiveList);
     }
 
     void on_rbAll_clicked(void)
     {
         active_filter_ = TaskFilter::kAll;
-        UpdateDisplayActiveTaskList();
+        ScheduleDisplay(kDisplayActiveList);
     }
 
     void on_rbSortName_clicked(void)
     {
         active_sort_ = TaskSort::kName;
-        UpdateDisplayActiveTaskList();
+        ScheduleDisplay(kDisplayActiveList);
     }
 
     void on_rbSortDeadline_clicked(void)
     {
         active_sort_ = TaskSort::kDeadline;
-        UpdateDisplayActiveTaskList();
+        ScheduleDisplay(kDisplayActiveList);
     }
 
     void SlotChangePrerequisites(QStringList i_list, TaskSelection i_select)
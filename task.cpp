@@ -18,148 +18,246 @@
 //    <https://github.com/CynicalTechHumor/Telos>
 
 #include "task.h"
+#include "taskfile.h"
+
+#include <algorithm>
 
 // Constructors & Destructor
 
 Task::Task(void)
 {
+    id_            = TaskGraph::INVALID_ID;
     name_          = "Task";
     description_   = "";
     deadline_      = QDateTime();
     completed_     = QDateTime();
-    prerequisites_ = std::vector<Task*>();
-    dependencies_  = std::vector<Task*>();
 }
 
 Task::Task(QString i_name, QString i_description, QDateTime i_deadline, QDateTime i_completed)
 {
-    name_          = i_name;
-    description_   = i_description;
-    deadline_      = i_deadline;
-    completed_     = i_completed;
-    prerequisites_ = std::vector<Task*>();
-    dependencies_  = std::vector<Task*>();
+    id_            = TaskGraph::INVALID_ID;
+    name_          = std::move(i_name);
+    description_   = std::move(i_description);
+    deadline_      = std::move(i_deadline);
+    completed_     = std::move(i_completed);
 }
 
 Task::~Task(void)
 {
 }
 
-bool Task::AreTaskPrereqComplete(void)
+void Task::MaterializeDescription(QFile* io_file) const
 {
-    if (prerequisites_.empty()) return true;       // Return true if no prerequisites
-    for(Task* i : prerequisites_)
-        if (!(i->IsTaskComplete())) return false;  // Return false if any prerequisite is incomplete...
-    return true;                                   // ...otherwise, return true
+    QByteArray bytes;
+    if (!description_source_.file->Read(description_source_, &bytes, io_file)) return;
+    description_        = QString::fromUtf8(bytes);
+    description_source_ = TaskDescriptionSource();
 }
 
-void Task::AddTaskPrereq(Task *i_task)
+QStringList Task::GetTaskNames(const std::vector<Task*>& i_list)
 {
-    if (!i_task) return;
-    if (prerequisites_.end() != std::find(prerequisites_.begin(), prerequisites_.end(), i_task));
-        prerequisites_.push_back(i_task);
+    QStringList r_list;
+    r_list.reserve(i_list.size());
+    for (Task* i : i_list) r_list.push_back(i->GetTaskName());
+    return r_list;
 }
 
-void Task::AddTaskDepend(Task *i_task)
+Task::PtrVector Task::SubtractTasks(const PtrVector& in_1, const PtrVector& in_2)
 {
-    if (!i_task) return;
-    if (dependencies_.end() != std::find(dependencies_.begin(), dependencies_.end(), i_task));
-        dependencies_.push_back(i_task);
+    // Keep entries of the first list that are not in the second list (or already kept)
+    std::unordered_set<Task*> excluded(in_2.begin(), in_2.end());
+    PtrVector out;
+    out.reserve(in_1.size());
+    for (Task* i : in_1)
+        if (excluded.insert(i).second)
+            out.push_back(i);
+    return out;
 }
 
-void Task::RemoveTaskPrereq(Task *i_ptr)
+Task::PtrVector Task::UniteTasks(const PtrVector& in_1, const PtrVector& in_2)
 {
-    std::vector<Task*>::iterator my_task_iter = std::find(prerequisites_.begin(), prerequisites_.end(), i_ptr);
-    if (my_task_iter != prerequisites_.end()) prerequisites_.erase(my_task_iter);
+    // Entries of the first list, then entries of the second list not seen yet
+    std::unordered_set<Task*> seen;
+    seen.reserve(in_1.size() + in_2.size());
+    PtrVector out;
+    out.reserve(in_1.size() + in_2.size());
+    for (const PtrVector* list : {&in_1, &in_2})
+        for (Task* i : *list)
+            if (seen.insert(i).second)
+                out.push_back(i);
+    return out;
 }
 
-void Task::RemoveTaskDepend(Task *i_ptr)
+Task::PtrVector Task::IntersectTasks(const PtrVector& in_1, const PtrVector& in_2)
 {
-    std::vector<Task*>::iterator my_task_iter = std::find(dependencies_.begin(), dependencies_.end(), i_ptr);
-    if (my_task_iter != dependencies_.end()) dependencies_.erase(my_task_iter);
+    // Keep entries of the first list that are in the second list; erase on match to skip duplicates
+    std::unordered_set<Task*> included(in_2.begin(), in_2.end());
+    PtrVector out;
+    for (Task* i : in_1)
+        if (included.erase(i))
+            out.push_back(i);
+    return out;
 }
 
-QStringList Task::GetTaskNames(std::vector<Task*> i_list)
+// Constructors & Destructor
+
+TaskList::TaskList(void)
 {
-    QStringList r_list;
-    for (std::vector<Task*>::iterator i = i_list.begin(); i != i_list.end(); ++i) r_list.push_back((*i)->GetTaskName());
-    return r_list;
+    name_                = "";
+    list_                = Task::PtrVector();
+    graph_version_       = 0;
+    chain_cache_version_ = 0;
+    visit_stamp_         = 0;
+    all_names_valid_     = false;
+    change_logging_      = false;
+    dirty_               = false;
+    journal_id_          = 0;
 }
 
-QStringList Task::SubtractTaskNames(QStringList in_1, QStringList in_2)
+TaskList::TaskList(QString input_name)
 {
-    QStringList out;
-    QString current;
-    bool match_found{false};
+    name_                = input_name;
+    list_                = Task::PtrVector();
+    graph_version_       = 0;
+    chain_cache_version_ = 0;
+    visit_stamp_         = 0;
+    all_names_valid_     = false;
+    change_logging_      = false;
+    dirty_               = false;
+    journal_id_          = 0;
+}
 
-    // Iterate through first list - if an entry does not match any entry in second list, add it to output list
-    while(!in_1.isEmpty())
-    {
-        current = in_1.front();
-        for (int i{0}; i<in_2.size() && !match_found; ++i)
-            if (current == in_2.at(i))
-                match_found = true;
-        if(!match_found)
-            out.append(current);
-        in_1.pop_front();
-        match_found=false;
-    }
-    return out;
+TaskList::~TaskList(void)
+{
+    Notify(TaskEvent::kClose);
+    event_handler_ = nullptr;
+    RemoveAllTasksFromList();
 }
 
-// Constructors & Destructor
+void TaskList::ReserveTasks(int i_count)
+{
+    // IDs of removed tasks are reused first, so only the remainder needs new IDs
+    int new_ids = i_count - static_cast<int>(free_ids_.size());
+    if (new_ids <= 0) return;
+    pool_.Reserve(i_count);
+    list_.reserve(list_.size() + new_ids);
+    incomplete_prereq_.reserve(list_.size() + new_ids);
+    state_.reserve(list_.size() + new_ids);
+    state_pos_.reserve(list_.size() + new_ids);
+    graph_.Reserve(list_.size() + new_ids);
+}
 
-TaskList::TaskList(void)
+int TaskList::ReleaseFileBuffer(void)
 {
-    name_ = "";
-    list_ = Task::PtrUniqueVector();
+    // Descriptions that can't be read any more are left empty
+    int lost_count = 0;
+    if (!file_buffer_) return lost_count;
+    QFile file;
+    for (Task* i : GetTaskRange())
+    {
+        if (!i->description_source_.length) continue;
+        i->MaterializeDescription(&file);
+        if (i->description_source_.length)
+        {
+            i->SetTaskDescription(QString());
+            ++lost_count;
+        }
+    }
+    file_buffer_.reset();
+    return lost_count;
 }
 
-TaskList::TaskList(QString input_name)
+void TaskList::TakeFileBuffer(TaskList& i_source)
 {
-    name_ = input_name;
-    list_ = Task::PtrUniqueVector();
+    // Descriptions left in this list's file are taken from the source's task of the same name, if any
+    if (file_buffer_ != i_source.file_buffer_)
+        for (Task* i : GetTaskRange())
+        {
+            if (!i->description_source_.length || i->description_source_.file == i_source.file_buffer_.get()) continue;
+            Task* source = i_source.GetPtrFromTaskList(i->GetTaskName());
+            if (source) TakeTaskDescription(i, source);
+            else        i->SetTaskDescription(QString());
+        }
+    file_buffer_ = i_source.file_buffer_;
 }
 
-TaskList::~TaskList(void)
+void TaskList::RemoveAllTasksFromList(void)
 {
+    // Destroy every task, then hand all of the pool's slabs back at once
+    for (Task* i : list_)
+        pool_.Destroy(i);
+    pool_.Release();
+    file_buffer_.reset();
+    list_.clear();
+    free_ids_.clear();
+    graph_.Clear();
+    ++graph_version_;
+    reachability_.Invalidate();
+    name_index_.clear();
+    all_names_valid_ = false;
+    incomplete_prereq_.clear();
+    state_.clear();
+    state_pos_.clear();
+    for (Task::IdVector& i : state_members_) i.clear();
+    Notify(TaskEvent::kReset);
 }
 
 std::vector<Task*> TaskList::GetAllTaskPtrsFromList(void)
 {
     Task::PtrVector list_ptrs;
-    for (Task::PtrUniqueVectorIterate i = list_.begin(); i<list_.end(); ++i)
-        list_ptrs.push_back((*i).get());
+    list_ptrs.reserve(GetTaskListSize());
+    for (Task* i : GetTaskRange())
+        list_ptrs.push_back(i);
     return list_ptrs;
 }
 
-QStringList TaskList::GetAllTaskNamesFromList(void)
+const QStringList& TaskList::GetAllTaskNamesFromList(void)
 {
-    QStringList list_names;
-    for (Task::PtrUniqueVectorIterate i = list_.begin(); i<list_.end(); ++i)
-        list_names.append((*i)->GetTaskName());
-    return list_names;
+    if (all_names_valid_) return all_names_;
+    all_names_.clear();
+    all_names_.reserve(GetTaskListSize());
+    for (Task* i : GetTaskRange())
+        all_names_.append(i->GetTaskName());
+    all_names_valid_ = true;
+    return all_names_;
 }
 
 Task::PtrVector TaskList::GetAllCompleted(void)
 {
     Task::PtrVector list_ptrs;
-    for (Task::PtrUniqueVectorIterate i = list_.begin(); i<list_.end(); ++i)
-        if ((*i)->GetTaskCompleted().isValid())
-            list_ptrs.push_back((*i).get());
+    list_ptrs.reserve(GetTaskIdsInState(TaskState::kCompleted).size());
+    for (Task* i : GetTaskRange())
+        if (i->IsTaskComplete())
+            list_ptrs.push_back(i);
     return list_ptrs;
 }
 
-Task* TaskList::GetPtrFromTaskList(QString i_name)
+Task::PtrVector TaskList::GetTaskPrereq(Task* i_ptr)
 {
-    Task *o_ptr = nullptr;
-    for (Task::PtrUniqueVectorIterate i = list_.begin(); i<list_.end(); ++i)
-        if((*i)->GetTaskName()==i_name)
-            o_ptr = (*i).get();
-    return o_ptr;
+    IdTaskRange prereqs = GetTaskPrereqRange(i_ptr);
+    Task::PtrVector o;
+    o.reserve(prereqs.size());
+    for (Task* i : prereqs)
+        o.push_back(i);
+    return o;
 }
 
-std::vector<Task*> TaskList::GetPtrsFromTaskList(QStringList i_list)
+Task::PtrVector TaskList::GetTaskDepend(Task* i_ptr)
+{
+    IdTaskRange depends = GetTaskDependRange(i_ptr);
+    Task::PtrVector o;
+    o.reserve(depends.size());
+    for (Task* i : depends)
+        o.push_back(i);
+    return o;
+}
+
+Task* TaskList::GetPtrFromTaskList(const QString& i_name)
+{
+    return name_index_.value(i_name, nullptr);
+}
+
+std::vector<Task*> TaskList::GetPtrsFromTaskList(const QStringList& i_list)
 {
     Task::PtrVector o;
     Task* temp;
@@ -171,71 +269,146 @@ std::vector<Task*> TaskList::GetPtrsFromTaskList(QStringList i_list)
     return o;
 }
 
-bool TaskList::CheckDuplicateTaskName(QString i_name, Task *i_ptr)
+std::vector<Task*> TaskList::GetPtrsFromIds(const Task::IdVector& i_ids)
 {
-    for (Task::PtrUniqueVectorIterate i = list_.begin(); i<list_.end(); ++i)
-        if ((*i)->GetTaskName() == i_name && (*i).get() != i_ptr)
+    Task::PtrVector o;
+    o.reserve(i_ids.size());
+    for (Task::Id i : i_ids)
+        if (Task* temp = GetPtrFromId(i)) o.push_back(temp);
+    return o;
+}
+
+bool TaskList::CheckDuplicateTaskName(const QString& i_name, Task *i_ptr)
+{
+    // Only tasks sharing the input name are visited, so this is O(1) for unique names
+    for (QMultiHash<QString, Task*>::const_iterator i = name_index_.constFind(i_name); i != name_index_.cend() && i.key() == i_name; ++i)
+        if (i.value() != i_ptr)
             return true;
     return false;
 }
 
-void TaskList::GetChainedPrereq(QStringList *o_list, QString i_name)
+const Task::IdVector& TaskList::GetChainedPrereq(Task* i_ptr)
 {
-    // Check input name, throw logic exception if input is not valid
-    Task* i_ptr{GetPtrFromTaskList(i_name)};
-    if (i_name.isEmpty() || !i_ptr)
-        throw std::logic_error("Invalid task name in prerequisite chain");
+    // Check input task, throw logic exception if input is not valid
+    if (!i_ptr || GetPtrFromId(i_ptr->GetTaskId()) != i_ptr)
+        throw std::logic_error("Invalid task in prerequisite chain");
+    return GetCachedChain(i_ptr->GetTaskId(), true);
+}
 
-    // Add the current name to the list if not already present
-    if (o_list->indexOf(i_name) == -1)
-        o_list->push_back(i_name);
+const Task::IdVector& TaskList::GetChainedDepend(Task* i_ptr)
+{
+    // Check input task, throw logic exception if input is not valid
+    if (!i_ptr || GetPtrFromId(i_ptr->GetTaskId()) != i_ptr)
+        throw std::logic_error("Invalid task in dependency chain");
+    return GetCachedChain(i_ptr->GetTaskId(), false);
+}
 
-    // Recursively call prerequisites to find all chained prerequisites
-    // Base case: no prerequisites to call
-    Task::PtrVector prereqs = i_ptr->GetTaskPrereq();
-    for (Task* i : prereqs)
-        this->GetChainedPrereq(o_list, i->GetTaskName());
+const Task::IdVector& TaskList::GetCachedChain(Task::Id i_id, bool i_prereq)
+{
+    // Drop cached chains if prerequisites changed since they were collected
+    if (chain_cache_version_ != graph_version_)
+    {
+        chained_prereq_cache_.clear();
+        chained_depend_cache_.clear();
+        chain_cache_version_ = graph_version_;
+    }
+
+    // Collect the chain only if it isn't cached yet
+    std::unordered_map<Task::Id, Task::IdVector>& cache = i_prereq ? chained_prereq_cache_ : chained_depend_cache_;
+    std::pair<std::unordered_map<Task::Id, Task::IdVector>::iterator, bool> cached = cache.emplace(i_id, Task::IdVector());
+    if (cached.second)
+        CollectChain(i_id, i_prereq, &cached.first->second);
+    return cached.first->second;
 }
 
-void TaskList::GetChainedDepend(QStringList *o_list, QString i_name)
+void TaskList::CollectChain(Task::Id i_id, bool i_prereq, Task::IdVector* o_chain)
 {
-    // Check input name, throw exception if input is not valid
-    Task* i_ptr{GetPtrFromTaskList(i_name)};
-    if (i_name.isEmpty() || !i_ptr)
-        throw std::logic_error("Invalid input name in dependency chain");
+    // New stamp marks every task as unvisited without clearing anything
+    // On the (very rare) wrap-around, reset the marks so old stamps can't collide
+    if (visit_mark_.size() < list_.size()) visit_mark_.resize(list_.size(), visit_stamp_);
+    if (++visit_stamp_ == 0)
+    {
+        std::fill(visit_mark_.begin(), visit_mark_.end(), 0);
+        visit_stamp_ = 1;
+    }
 
-    // Add the current name to the list if not already present
-    if (o_list->indexOf(i_name) == -1)
-        o_list->push_back(i_name);
+    // Depth-first walk with an explicit stack, so long chains can't overflow the call stack
+    // Tasks are marked when first reached, so shared prerequisites/dependents are only expanded once
+    o_chain->push_back(i_id);
+    visit_mark_[i_id] = visit_stamp_;
+    Task::IdVector stack(1, i_id);
+    while (!stack.empty())
+    {
+        Task::Id current = stack.back();
+        stack.pop_back();
+        for (Task::Id i : i_prereq ? graph_.GetPrereq(current) : graph_.GetDepend(current))
+        {
+            if (visit_mark_[i] == visit_stamp_) continue;
+            visit_mark_[i] = visit_stamp_;
+            o_chain->push_back(i);
+            stack.push_back(i);
+        }
+    }
+}
 
-    // Recursively call prerequisites to find all chained dependents
-    // Base case: no dependents to call
-    Task::PtrVector depend = i_ptr->GetTaskDepend();
-    for (Task* i : depend)
-        this->GetChainedDepend(o_list, i->GetTaskName());
+bool TaskList::IsChainedPrereq(Task* i_task, Task* i_prereq)
+{
+    if (!i_task || !i_prereq) return false;
+    if (EnsureReachability()) return reachability_.IsChainedPrereq(i_task->GetTaskId(), i_prereq->GetTaskId());
+    const Task::IdVector& chain = GetChainedPrereq(i_task);
+    return std::find(chain.begin() + 1, chain.end(), i_prereq->GetTaskId()) != chain.end();
 }
 
-void TaskList::GetCompleted(QStringList* o_list)
+Task::PtrVector TaskList::GetEligiblePrereq(Task* i_task, const Task::PtrVector& i_prereq)
 {
-    for(Task::PtrUniqueVectorIterate i = list_.begin(); i != list_.end(); ++i)
-        if ((*i)->GetTaskCompleted().isValid())
-            o_list->push_back((*i)->GetTaskName());
+    Task::PtrVector o;
+    if (!i_task) return o;
+    Task::Id task_id = i_task->GetTaskId();
+    if (!EnsureReachability())
+    {
+        // Lists too large to index: mark the task's dependents and the current prerequisites' chains, then skip them
+        std::vector<uint8_t> excluded(list_.size(), 0);
+        for (Task::Id i : GetChainedDepend(i_task))
+            excluded[i] = 1;
+        for (Task* i : i_prereq)
+            if (i)
+                for (Task::Id j : GetChainedPrereq(i))
+                    excluded[j] = 1;
+        for (TaskState i_state : {TaskState::kCurrent, TaskState::kPending})
+            for (Task::Id i : GetTaskIdsInState(i_state))
+                if (!excluded[i]) o.push_back(list_[i]);
+        return o;
+    }
+
+    // Mask of the current prerequisites and everything in their chains
+    std::vector<uint64_t> redundant(reachability_.GetWordCount(), 0);
+    for (Task* i : i_prereq)
+        if (i) reachability_.MergeChainedPrereq(i->GetTaskId(), &redundant);
+
+    // Only incomplete tasks can be eligible; each check is a couple of bit tests
+    for (TaskState i_state : {TaskState::kCurrent, TaskState::kPending})
+        for (Task::Id i : GetTaskIdsInState(i_state))
+            if (i != task_id
+             && !reachability_.IsChainedPrereq(i, task_id)
+             && !TaskReachability::TestBit(redundant, i))
+                o.push_back(list_[i]);
+    return o;
 }
 
-void TaskList::SetTaskPrereqFromList(QString i_task, QStringList i_task_prereq)
+void TaskList::SetTaskPrereqFromList(const QString& i_task, const QStringList& i_task_prereq)
 {
     Task* task_ptr{GetPtrFromTaskList(i_task)};
     Task::PtrVector task_prereq_ptrs = GetPtrsFromTaskList(i_task_prereq);
     for (Task* i : task_prereq_ptrs)
-        task_ptr->AddTaskPrereq(i);
+        AddTaskPrereq(task_ptr, i);
 }
 
-void TaskList::SetTaskDependFromList(QString i_task, QStringList i_task_depend)
+void TaskList::SetTaskDependFromList(const QString& i_task, const QStringList& i_task_depend)
 {
     Task* task_ptr{GetPtrFromTaskList(i_task)};
     Task::PtrVector task_depend_ptrs = GetPtrsFromTaskList(i_task_depend);
     for (Task* i : task_depend_ptrs)
-        task_ptr->AddTaskDepend(i);
+        AddTaskPrereq(i, task_ptr);
 }
 
 Task* TaskList::AddTaskToList(QString   i_name,
@@ -243,29 +416,281 @@ Task* TaskList::AddTaskToList(QString   i_name,
                               QDateTime i_deadline,
                               QDateTime i_completed)
 {
-    list_.push_back(std::make_unique<Task>(i_name, i_description, i_deadline, i_completed));
-    return list_.back().get();
+    // Reuse the ID of a removed task if there is one, otherwise take the next ID
+    Task::Id new_id;
+    if (!free_ids_.empty())
+    {
+        new_id = free_ids_.back();
+        free_ids_.pop_back();
+    }
+    else
+    {
+        new_id = list_.size();
+        list_.emplace_back();
+        graph_.Reserve(list_.size());
+        if (new_id >= reachability_.GetCapacity()) reachability_.Invalidate();
+        incomplete_prereq_.push_back(0);
+        state_.push_back(0);
+        state_pos_.push_back(0);
+    }
+
+    list_[new_id] = pool_.Create(std::move(i_name), std::move(i_description), std::move(i_deadline), std::move(i_completed));
+    list_[new_id]->id_ = new_id;
+    name_index_.insert(list_[new_id]->GetTaskName(), list_[new_id]);
+    all_names_valid_ = false;
+
+    // New tasks have no prerequisites, so they start out current (or completed)
+    incomplete_prereq_[new_id] = 0;
+    UpdateTaskState(new_id, true);
+
+    // A new task is logged as created, followed by whichever fields it was created with
+    Task* o_task = list_[new_id];
+    if (change_logging_)
+    {
+        LogChange(o_task, TaskChange::kCreate);
+        if (o_task->HasTaskDescription())         LogChange(o_task, TaskChange::kDescription, o_task->GetTaskDescription());
+        if (o_task->GetTaskDeadline().isValid())  LogChange(o_task, TaskChange::kDeadline,    QString(), o_task->GetTaskDeadline());
+        if (o_task->GetTaskCompleted().isValid()) LogChange(o_task, TaskChange::kCompleted,   QString(), o_task->GetTaskCompleted());
+    }
+    Notify(TaskEvent::kAdd, new_id);
+    return o_task;
+}
+
+void TaskList::SetTaskName(Task* i_ptr, const QString& i_name)
+{
+    if (!i_ptr || i_ptr->GetTaskName() == i_name) return;
+    LogChange(i_ptr, TaskChange::kRename, i_name);
+    name_index_.remove(i_ptr->GetTaskName(), i_ptr);
+    i_ptr->SetTaskName(i_name);
+    name_index_.insert(i_name, i_ptr);
+    all_names_valid_ = false;
+    Notify(TaskEvent::kReorder, i_ptr->GetTaskId());
+}
+
+void TaskList::SetTaskDescription(Task* i_ptr, const QString& i_description)
+{
+    if (!i_ptr || i_ptr->GetTaskDescription() == i_description) return;
+    LogChange(i_ptr, TaskChange::kDescription, i_description);
+    i_ptr->SetTaskDescription(i_description);
+    Notify(TaskEvent::kChange, i_ptr->GetTaskId());
+}
+
+void TaskList::SetTaskDeadline(Task* i_ptr, const QDateTime& i_deadline)
+{
+    if (!i_ptr || i_ptr->GetTaskDeadline() == i_deadline) return;
+    LogChange(i_ptr, TaskChange::kDeadline, QString(), i_deadline);
+    i_ptr->SetTaskDeadline(i_deadline);
+    Notify(TaskEvent::kReorder, i_ptr->GetTaskId());
+}
+
+void TaskList::SetTaskCompleted(Task* i_ptr, const QDateTime& i_completed)
+{
+    if (!i_ptr) return;
+    if (i_ptr->GetTaskCompleted() != i_completed)
+        LogChange(i_ptr, TaskChange::kCompleted, QString(), i_completed);
+    bool was_complete = i_ptr->IsTaskComplete();
+    i_ptr->SetTaskCompleted(i_completed);
+    if (was_complete == i_ptr->IsTaskComplete())
+    {
+        Notify(TaskEvent::kChange, i_ptr->GetTaskId());
+        return;
+    }
+
+    // Completion changed: every dependent gains/loses one incomplete prerequisite
+    for (Task::Id i : graph_.GetDepend(i_ptr->GetTaskId()))
+    {
+        if (was_complete) ++incomplete_prereq_[i];
+        else              --incomplete_prereq_[i];
+        UpdateTaskState(i);
+    }
+    UpdateTaskState(i_ptr->GetTaskId());
+}
+
+void TaskList::AddTaskPrereq(Task* i_task, Task* i_prereq)
+{
+    if (!i_task || !i_prereq) return;
+    if (!graph_.AddEdge(i_task->GetTaskId(), i_prereq->GetTaskId())) return;
+    LogChange(i_task, TaskChange::kLink, i_prereq->GetTaskName());
+    ++graph_version_;
+    reachability_.AddEdge(graph_, i_task->GetTaskId(), i_prereq->GetTaskId());
+    if (!i_prereq->IsTaskComplete())
+    {
+        ++incomplete_prereq_[i_task->GetTaskId()];
+        UpdateTaskState(i_task->GetTaskId());
+    }
+    Notify(TaskEvent::kChange, i_task->GetTaskId());
+}
+
+void TaskList::RemoveTaskPrereq(Task* i_task, Task* i_prereq)
+{
+    if (!i_task || !i_prereq) return;
+    if (!graph_.RemoveEdge(i_task->GetTaskId(), i_prereq->GetTaskId())) return;
+    LogChange(i_task, TaskChange::kUnlink, i_prereq->GetTaskName());
+    ++graph_version_;
+    reachability_.RemoveEdges(graph_, Task::IdVector(1, i_task->GetTaskId()));
+    if (!i_prereq->IsTaskComplete())
+    {
+        --incomplete_prereq_[i_task->GetTaskId()];
+        UpdateTaskState(i_task->GetTaskId());
+    }
+    Notify(TaskEvent::kChange, i_task->GetTaskId());
 }
 
 void TaskList::RemoveTaskFromList(Task* i_ptr)
 {
-    DisconnectPrereqDepend(i_ptr);
-    Task::PtrUniqueVectorIterate i = std::find_if(list_.begin(), list_.end(), [i_ptr](Task::PtrUnique& e) {return e.get() == i_ptr;});
-    if (i != list_.end()) list_.erase(i);
+    // Ignore tasks that aren't (or are no longer) in this list
+    if (!i_ptr || GetPtrFromId(i_ptr->GetTaskId()) != i_ptr) return;
+
+    // Its links go with it, so only the removal itself is logged
+    // An incomplete task no longer holds back its dependents once removed
+    LogChange(i_ptr, TaskChange::kRemove);
+    Task::Id removed_id = i_ptr->GetTaskId();
+    dirty_tasks_.erase(removed_id);
+    if (!i_ptr->IsTaskComplete())
+        for (Task::Id i : graph_.GetDepend(removed_id))
+        {
+            --incomplete_prereq_[i];
+            UpdateTaskState(i);
+        }
+    RemoveTaskState(removed_id);
+    Task::IdVector unlinked(1, removed_id);
+    for (Task::Id i : graph_.GetDepend(removed_id))
+        unlinked.push_back(i);
+    graph_.RemoveAllEdges(removed_id);
+    ++graph_version_;
+    reachability_.RemoveEdges(graph_, unlinked);
+    name_index_.remove(i_ptr->GetTaskName(), i_ptr);
+    all_names_valid_ = false;
+    pool_.Destroy(list_[removed_id]);
+    list_[removed_id] = nullptr;
+    free_ids_.push_back(removed_id);
+    Notify(TaskEvent::kRemove, removed_id);
 }
 
-void TaskList::RemoveTasksFromList(Task::PtrVector i_list)
+void TaskList::RemoveTasksFromList(const Task::PtrVector& i_list)
 {
+    std::function<void(const TaskEvent&)> handler = std::exchange(event_handler_, nullptr);
     for (Task* i : i_list)
         RemoveTaskFromList(i);
+    event_handler_ = std::move(handler);
+    if (!i_list.empty()) Notify(TaskEvent::kReset);
+}
+
+void TaskList::SyncTaskList(TaskList& i_source, int* o_added, int* o_changed, int* o_removed)
+{
+    // Remove the tasks the source doesn't have
+    std::function<void(const TaskEvent&)> handler = std::exchange(event_handler_, nullptr);
+    Task::PtrVector removed;
+    for (Task* i : GetTaskRange())
+        if (!i_source.GetPtrFromTaskList(i->GetTaskName())) removed.push_back(i);
+    RemoveTasksFromList(removed);
+    *o_removed = static_cast<int>(removed.size());
+    *o_added   = 0;
+    *o_changed = 0;
+
+    // Add the tasks only the source has, and update the fields of the rest
+    // Every task is matched up before linking, since a prerequisite may come later in the source
+    std::vector<std::pair<Task*, Task*>> matched;  // Task, source task
+    std::vector<bool>                    changed;  // Task is new, or differed from the source
+    matched.reserve(i_source.GetTaskListSize());
+    changed.reserve(i_source.GetTaskListSize());
+    for (Task* i : i_source.GetTaskRange())
+    {
+        Task* task = GetPtrFromTaskList(i->GetTaskName());
+        if (!task)
+        {
+            task = AddTaskToList(i->GetTaskName(), QString(), i->GetTaskDeadline(), i->GetTaskCompleted());
+            TakeTaskDescription(task, i);
+            matched.emplace_back(task, i);
+            changed.push_back(true);
+            ++*o_added;
+            continue;
+        }
+        bool differs = !IsSameTaskDescription(task, i)
+                    || task->GetTaskDeadline()  != i->GetTaskDeadline()
+                    || task->GetTaskCompleted() != i->GetTaskCompleted();
+        TakeTaskDescription(task, i);
+        SetTaskDeadline    (task, i->GetTaskDeadline());
+        if (task->GetTaskCompleted() != i->GetTaskCompleted()) SetTaskCompleted(task, i->GetTaskCompleted());
+        matched.emplace_back(task, i);
+        changed.push_back(differs);
+        if (differs) ++*o_changed;
+    }
+
+    // Unlink the prerequisites the source doesn't have, then link the ones it adds
+    for (size_t i=0; i<matched.size(); ++i)
+    {
+        Task*           task = matched[i].first;
+        Task::PtrVector wanted,
+                        current = GetTaskPrereq(task);
+        for (Task* j : i_source.GetTaskPrereqRange(matched[i].second))
+            if (Task* prereq = GetPtrFromTaskList(j->GetTaskName())) wanted.push_back(prereq);
+        bool differs = false;
+        for (Task* j : current)
+            if (std::find(wanted.begin(), wanted.end(), j) == wanted.end())
+            {
+                RemoveTaskPrereq(task, j);
+                differs = true;
+            }
+        for (Task* j : wanted)
+            if (std::find(current.begin(), current.end(), j) == current.end())
+            {
+                AddTaskPrereq(task, j);
+                differs = true;
+            }
+        if (differs && !changed[i])
+        {
+            changed[i] = true;
+            ++*o_changed;
+        }
+    }
+
+    TakeFileBuffer(i_source);
+    event_handler_ = std::move(handler);
+    if (*o_added || *o_changed || *o_removed) Notify(TaskEvent::kReset);
+}
+
+bool TaskList::IsSameTaskDescription(const Task* i_task, const Task* i_source)
+{
+    // Descriptions neither task has read are only compared by length: the task's file has been replaced by the source's
+    if (i_task->GetTaskDescriptionSource().length && i_source->GetTaskDescriptionSource().length)
+        return i_task->GetTaskDescriptionSource().length == i_source->GetTaskDescriptionSource().length;
+    return i_task->GetTaskDescription() == i_source->GetTaskDescription();
+}
+
+void TaskList::TakeTaskDescription(Task* io_task, const Task* i_source)
+{
+    // Unconverted descriptions are taken over as the bytes in the source's buffer, so the task no longer refers to this list's
+    if (i_source->GetTaskDescriptionSource().length)
+        io_task->SetTaskDescriptionSource(i_source->GetTaskDescriptionSource());
+    else if (io_task->GetTaskDescriptionSource().length || io_task->GetTaskDescription() != i_source->GetTaskDescription())
+        io_task->SetTaskDescription(i_source->GetTaskDescription());
+}
+
+void TaskList::UpdateTaskState(Task::Id i_id, bool i_new)
+{
+    TaskState new_state = list_[i_id]->IsTaskComplete() ? TaskState::kCompleted
+                        : incomplete_prereq_[i_id]      ? TaskState::kPending
+                                                        : TaskState::kCurrent;
+    if (!i_new)
+    {
+        if (static_cast<TaskState>(state_[i_id]) == new_state) return;
+        RemoveTaskState(i_id);
+    }
+
+    Task::IdVector& members = state_members_[static_cast<int>(new_state)];
+    state_[i_id]     = static_cast<uint8_t>(new_state);
+    state_pos_[i_id] = members.size();
+    members.push_back(i_id);
+    if (!i_new) Notify(TaskEvent::kChange, i_id);
 }
 
-void TaskList::DisconnectPrereqDepend(Task *i_ptr)
+void TaskList::RemoveTaskState(Task::Id i_id)
 {
-    Task::PtrVector prereqs = i_ptr->GetTaskPrereq(),
-                    depends = i_ptr->GetTaskDepend();
-    for (Task::PtrVectorIterate i=prereqs.begin(); i!=prereqs.end(); ++i)
-            (*i)->RemoveTaskDepend(i_ptr);
-    for (Task::PtrVectorIterate i=depends.begin(); i!=depends.end(); ++i)
-            (*i)->RemoveTaskPrereq(i_ptr);
+    // Swap with the last member of the set, so removal is O(1)
+    Task::IdVector& members = state_members_[state_[i_id]];
+    Task::Id        moved   = members.back();
+    members[state_pos_[i_id]] = moved;
+    state_pos_[moved]         = state_pos_[i_id];
+    members.pop_back();
 }
@@ -20,14 +20,60 @@
 #ifndef TASK_H
 #define TASK_H
 
+#include "taskgraph.h"
+#include "taskpool.h"
+
 #include <QDateTime>
+#include <QMultiHash>
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+class QFile;
+class TaskFileBuffer;
+
+// TaskDescriptionSource()
+// Where a description not read yet is saved: a range of bytes in the file its task was loaded from
+struct TaskDescriptionSource
+{
+    const TaskFileBuffer* file   = nullptr;
+    uint32_t              offset = 0;
+    uint32_t              length = 0;  // 0 if there is none
+};
+
+// Completion state of a task within its list
+// kCurrent: incomplete, all prerequisites complete; kPending: incomplete, some prerequisite incomplete
+enum class TaskState : uint8_t {kCurrent, kPending, kCompleted};
+
+// TaskChange()
+// One change made to a task list, as recorded for the list's change journal (see TaskList::SetChangeLogging())
+// Tasks are identified by name, so a change can be applied to another copy of the list, e.g. one loaded from disk
+struct TaskChange
+{
+    enum Type : uint8_t {kCreate, kRename, kDescription, kDeadline, kCompleted, kLink, kUnlink, kRemove, kTypeCount};
+
+    Type      type;
+    QString   name;  // Task changed (its previous name, for kRename)
+    QString   text;  // New name (kRename), description (kDescription) or prerequisite name (kLink, kUnlink)
+    QDateTime time;  // New deadline (kDeadline) or completion time (kCompleted); invalid if cleared
+};
 
 // Task()
 // Encapsulates all information about a task to be completed
 class Task
 {
+    // TaskList keeps a name index, assigns IDs and tracks completion state,
+    // so renaming/completing must go through TaskList::SetTaskName()/SetTaskCompleted()
+    friend class TaskList;
+
 public:
 
+    typedef TaskGraph::Id                                Id;
+    typedef TaskGraph::IdRange                           IdRange;
+    typedef std::vector<Id>                              IdVector;
     typedef std::unique_ptr<Task>                        PtrUnique;
     typedef std::vector<Task*>                           PtrVector;
     typedef std::vector<Task*>::iterator                 PtrVectorIterate;
@@ -39,40 +85,44 @@ public:
     // *************************
 
     Task();
-    Task(QString i_name, QString i_description, QDateTime i_deadline, QDateTime i_completed);
+    Task(QString i_name, QString i_description, QDateTime i_deadline, QDateTime i_completed);  // Arguments are moved in
     ~Task();
 
     // *********
     // Accessors
     // *********
 
-    QString            GetTaskName        (void) { return name_;                }
-    QString            GetTaskDescription (void) { return description_;         }
-    QDateTime          GetTaskDeadline    (void) { return deadline_;            }
-    QDateTime          GetTaskCompleted   (void) { return completed_;           }
-    std::vector<Task*> GetTaskPrereq      (void) { return prerequisites_;       }
-    std::vector<Task*> GetTaskDepend      (void) { return dependencies_;        }
-    bool               IsTaskComplete     (void) { return completed_.isValid(); }
+    // Prerequisites/dependents are stored in the owning TaskList's graph, keyed by task ID
 
-    bool AreTaskPrereqComplete(void);
+    // Strings/dates are returned by reference, valid until the task is changed or removed
+
+    Id                 GetTaskId          (void) const { return id_;                  }
+    const QString&     GetTaskName        (void) const { return name_;                }
+    const QDateTime&   GetTaskDeadline    (void) const { return deadline_;            }
+    const QDateTime&   GetTaskCompleted   (void) const { return completed_;           }
+    bool               IsTaskComplete     (void) const { return completed_.isValid(); }
+
+    // GetTaskDescription(), HasTaskDescription(), GetTaskDescriptionSource()
+    // A description loaded from a file is left there (its "source") until first read; not thread-safe, as reading it
+    // may modify the task
+    const QString&        GetTaskDescription       (void) const { if (description_source_.length) MaterializeDescription(); return description_; }
+    bool                  HasTaskDescription       (void) const { return description_source_.length || !description_.isEmpty();                   }
+    TaskDescriptionSource GetTaskDescriptionSource (void) const { return description_source_;                                                        }
 
     // ********
     // Mutators
     // ********
 
-    void SetTaskName        (QString            input_string   ) { name_          = input_string;    }
-    void SetTaskDescription (QString            input_string   ) { description_   = input_string;    }
-    void SetTaskDeadline    (QDateTime          input_datetime ) { deadline_      = input_datetime;  }
-    void SetTaskCompleted   (QDateTime          input_datetime ) { completed_     = input_datetime;  }
-    void SetTaskPrereq      (std::vector<Task*> input_task_list) { prerequisites_ = input_task_list; }
-    void SetTaskDepend      (std::vector<Task*> input_task_list) { dependencies_  = input_task_list; }
+    // Temporaries are moved in rather than copied
 
-    // Add/remove task prereq/depend
-    // Does nothing if input is invalid
-    void AddTaskPrereq    (Task*);
-    void AddTaskDepend    (Task*);
-    void RemoveTaskPrereq (Task*);
-    void RemoveTaskDepend (Task*);
+    void SetTaskDescription (const QString&     input_string   ) { description_   = input_string;              description_source_ = TaskDescriptionSource(); }
+    void SetTaskDescription (QString&&          input_string   ) { description_   = std::move(input_string);   description_source_ = TaskDescriptionSource(); }
+    void SetTaskDeadline    (const QDateTime&   input_datetime ) { deadline_      = input_datetime;            }
+    void SetTaskDeadline    (QDateTime&&        input_datetime ) { deadline_      = std::move(input_datetime); }
+
+    // SetTaskDescriptionSource()
+    // Set the description as UTF-8 bytes in a file, read on first use; the file must be its list's (see TaskList::SetFileBuffer())
+    void SetTaskDescriptionSource (const TaskDescriptionSource& i_source) { description_.clear(); description_source_ = i_source; }
 
     // ******
     // Static
@@ -82,24 +132,44 @@ public:
     // Input:   Vector of task pointers.
     // Returns: String list containing names of all tasks within input vector; empty list if input vector is empty.
     // Assumes: All pointers are valid; All task names are valid.
-    static QStringList GetTaskNames (std::vector<Task*>);
+    static QStringList GetTaskNames (const std::vector<Task*>&);
 
-    // SubtractTaskNames() - static
-    // Remove strings from list 1 that match any string in list 2
-    // Useful for removing tasks from a list which are not applicable to a specific function
-    // i.e. when adding a new prerequisite, remove existing prerequisites/dependencies from the options
-    static QStringList SubtractTaskNames(QStringList, QStringList);
+    // SubtractTasks(), UniteTasks(), IntersectTasks() - static
+    // Set difference/union/intersection of two task pointer vectors, in the order of the first, without duplicates
+    // Useful for comparing sets of tasks, i.e. finding prerequisites added/removed since a task was loaded
+    static std::vector<Task*> SubtractTasks  (const std::vector<Task*>&, const std::vector<Task*>&);
+    static std::vector<Task*> UniteTasks     (const std::vector<Task*>&, const std::vector<Task*>&);
+    static std::vector<Task*> IntersectTasks (const std::vector<Task*>&, const std::vector<Task*>&);
 
 protected:
 
+    // Renamed/completed only through TaskList::SetTaskName()/SetTaskCompleted()
+    void SetTaskName        (QString            input_string   ) { name_          = std::move(input_string);   }
+    void SetTaskCompleted   (QDateTime          input_datetime ) { completed_     = std::move(input_datetime); }
+
     // Data
-    QString            name_;
-    QString            description_;
-    QDateTime          deadline_;
-    QDateTime          completed_;
-    std::vector<Task*> prerequisites_;
-    std::vector<Task*> dependencies_;
+    Id                            id_;
+    QString                       name_;
+    mutable QString               description_;
+    mutable TaskDescriptionSource description_source_;  // See GetTaskDescriptionSource()
+    QDateTime                     deadline_;
+    QDateTime                     completed_;
+
+    // Read the description source into description_; left as is if the file can't be read (see TaskFileBuffer::Read())
+    // Readers of many descriptions pass the same QFile, so the file is only opened once
+    void MaterializeDescription (QFile* io_file = nullptr) const;
+
+};
+
+// TaskEvent()
+// One change to a task list, as reported to its event handler (see TaskList::SetEventHandler())
+// kReorder: a name or deadline changed; kReset: every task may have changed; kClose: the list is being destroyed
+struct TaskEvent
+{
+    enum Type : uint8_t {kAdd, kRemove, kChange, kReorder, kReset, kClose};
 
+    Type          type;
+    TaskGraph::Id id;    // Task added, removed (its ID may already be reused) or changed; unused otherwise
 };
 
 // TaskList()
@@ -124,19 +194,117 @@ public:
     TaskList(QString);
     ~TaskList();
 
+    // Tasks are owned through raw pointers into the list's pool, so a list can't be copied
+    TaskList(const TaskList&)            = delete;
+    TaskList& operator=(const TaskList&) = delete;
+
+    // TaskRange, IdTaskRange
+    // Ranges yielding Task*: every task in ID order, or the tasks of a view of IDs (e.g. a task's prerequisites)
+    // Invalidated by adding/removing tasks; IdTaskRange also by changing prerequisites
+    class TaskRange
+    {
+    public:
+        class iterator
+        {
+        public:
+            iterator(Task* const* i_pos, Task* const* i_end) : pos_(i_pos), end_(i_end) { SkipRemoved(); }
+
+            Task*     operator*  (void)                  const { return *pos_;                        }
+            iterator& operator++ (void)                        { ++pos_; SkipRemoved(); return *this; }
+            bool      operator== (const iterator& i_rhs) const { return pos_ == i_rhs.pos_;           }
+            bool      operator!= (const iterator& i_rhs) const { return pos_ != i_rhs.pos_;           }
+
+        private:
+            void SkipRemoved (void) { while (pos_ != end_ && !*pos_) ++pos_; }
+
+            Task* const* pos_;
+            Task* const* end_;
+        };
+
+        TaskRange(Task* const* i_begin, Task* const* i_end) : begin_(i_begin), end_(i_end) {}
+
+        iterator begin (void) const { return iterator(begin_, end_); }
+        iterator end   (void) const { return iterator(end_, end_);   }
+
+    private:
+        Task* const* begin_;
+        Task* const* end_;
+    };
+
+    class IdTaskRange
+    {
+    public:
+        class iterator
+        {
+        public:
+            iterator(const Task::Id* i_pos, Task* const* i_tasks) : pos_(i_pos), tasks_(i_tasks) {}
+
+            Task*     operator*  (void)                  const { return tasks_[*pos_];      }
+            iterator& operator++ (void)                        { ++pos_; return *this;       }
+            bool      operator== (const iterator& i_rhs) const { return pos_ == i_rhs.pos_;  }
+            bool      operator!= (const iterator& i_rhs) const { return pos_ != i_rhs.pos_;  }
+
+        private:
+            const Task::Id* pos_;
+            Task* const*    tasks_;
+        };
+
+        IdTaskRange(Task::IdRange i_ids, Task* const* i_tasks) : ids_(i_ids), tasks_(i_tasks) {}
+
+        iterator begin (void) const { return iterator(ids_.begin(), tasks_); }
+        iterator end   (void) const { return iterator(ids_.end(), tasks_);   }
+        size_t   size  (void) const { return ids_.size();                    }
+        bool     empty (void) const { return ids_.empty();                   }
+
+    private:
+        Task::IdRange ids_;
+        Task* const*  tasks_;
+    };
+
     // *********
     // Accessors
     // *********
 
-    QString GetTaskListName (void)  { return name_;          }
-    int     GetTaskListSize (void)  { return list_.size();   }
-    bool    IsTaskListEmpty (void)  { return list_.empty();  }
-    Task*   operator[]      (int i) { return list_[i].get(); }
+    const QString& GetTaskListName (void)       const { return name_;                                       }
+    int            GetTaskListSize (void)       const { return list_.size() - free_ids_.size();             }
+    bool           IsTaskListEmpty (void)       const { return GetTaskListSize() == 0;                      }
+    Task*          GetPtrFromId    (Task::Id i) const { return i < list_.size() ? list_[i] : nullptr;       }
+    Task::Id       GetTaskIdBound  (void)       const { return list_.size();                                } // Every task ID is below this
+
+    // GetTaskRange()
+    // Every task currently in the list, without copying pointers into a vector
+    TaskRange GetTaskRange (void) const { return TaskRange(list_.data(), list_.data() + list_.size()); }
+
+    // GetTaskPrereqIds(), GetTaskDependIds()
+    // View of the IDs of a task's direct prerequisites/dependents, in the order they were linked
+    // Invalidated by the next change to the list's prerequisites
+    Task::IdRange GetTaskPrereqIds (const Task* i_ptr) const { return graph_.GetPrereq(i_ptr->GetTaskId()); }
+    Task::IdRange GetTaskDependIds (const Task* i_ptr) const { return graph_.GetDepend(i_ptr->GetTaskId()); }
+
+    // GetTaskPrereqRange(), GetTaskDependRange()
+    // Iterate over a task's direct prerequisites/dependents as pointers, in the order they were linked
+    IdTaskRange GetTaskPrereqRange (const Task* i_ptr) const { return IdTaskRange(GetTaskPrereqIds(i_ptr), list_.data()); }
+    IdTaskRange GetTaskDependRange (const Task* i_ptr) const { return IdTaskRange(GetTaskDependIds(i_ptr), list_.data()); }
+
+    // GetTaskPrereq(), GetTaskDepend()
+    // Get a vector of pointers to a task's direct prerequisites/dependents
+    // Prefer the ranges above when the result doesn't need to outlive a change to the list
+    std::vector<Task*> GetTaskPrereq (Task*);
+    std::vector<Task*> GetTaskDepend (Task*);
+
+    // AreTaskPrereqComplete()
+    // True if every direct prerequisite of the task is complete (or it has none)
+    bool AreTaskPrereqComplete(Task* i_ptr) { return incomplete_prereq_[i_ptr->GetTaskId()] == 0; }
+
+    // GetTaskState(), GetTaskIdsInState()
+    // Current/pending/completed state of a task, or the IDs of all tasks in a state (in no particular order)
+    TaskState             GetTaskState      (Task* i_ptr)     { return static_cast<TaskState>(state_[i_ptr->GetTaskId()]); }
+    const Task::IdVector& GetTaskIdsInState (TaskState i_state) { return state_members_[static_cast<int>(i_state)];        }
 
     // GetAllTaskPtrsFromList(), GetAllTaskNamesFromList()
     // Get a vector of pointers, or a string list of the names for all Tasks currently in the list
     std::vector<Task*> GetAllTaskPtrsFromList  (void);
-    QStringList        GetAllTaskNamesFromList (void);
+    const QStringList& GetAllTaskNamesFromList (void);
 
     // GetAllCompleted()
     // Get a vector of pointers for completed tasks only
@@ -145,51 +313,177 @@ public:
     // GetPtrFromTaskList(), GetPtrsFromTaskList
     // Return pointer (or a vector of pointers) to the task(s) identified by name
     // Return nullptr/empty vector if the task(s) is/are not in the list
-    Task* GetPtrFromTaskList(QString i_name);
-    std::vector<Task*> GetPtrsFromTaskList(QStringList i_list);
+    Task* GetPtrFromTaskList(const QString& i_name);
+    std::vector<Task*> GetPtrsFromTaskList(const QStringList& i_list);
+
+    // GetPtrsFromIds()
+    // Return a vector of pointers to the tasks identified by ID (e.g. a prerequisite chain)
+    std::vector<Task*> GetPtrsFromIds(const Task::IdVector&);
 
     // CheckDuplicateTaskName()
     // Checks list for any existing task with the input name
     // Also takes an input pointer identifying one task with that name to be ignored
     // Useful for preventing duplicate task names
-    bool CheckDuplicateTaskName(QString, Task* = nullptr);
+    bool CheckDuplicateTaskName(const QString&, Task* = nullptr);
 
     // GetChainedPrereq(), GetChainedDepend()
-    // Get all prerequisites/dependents for a given task in list, including all others in the chain
-    // i.e. prerequisites of prerequisites, dependents of dependents
-    void GetChainedPrereq (QStringList*, QString);
-    void GetChainedDepend (QStringList*, QString);
-    void GetCompleted     (QStringList*);
+    // Get the IDs of a task (first) and all of its prerequisites/dependents, including all others in the chain
+    // Cached, and valid until the list's prerequisites next change
+    const Task::IdVector& GetChainedPrereq (Task*);
+    const Task::IdVector& GetChainedDepend (Task*);
+
+    // IsChainedPrereq(), CanAddTaskPrereq()
+    // True if i_prereq is anywhere in the prerequisite chain of i_task; if it can be linked without creating a cycle
+    bool IsChainedPrereq  (Task* i_task, Task* i_prereq);
+    bool CanAddTaskPrereq (Task* i_task, Task* i_prereq) { return i_task != i_prereq && !IsChainedPrereq(i_prereq, i_task); }
+
+    // GetEligiblePrereq()
+    // Get the incomplete tasks that may be added as new prerequisites of a task without a cycle or redundant link
+    std::vector<Task*> GetEligiblePrereq(Task* i_task, const std::vector<Task*>& i_prereq);
 
     // ********
     // Mutators
     // ********
 
-    void SetTaskListName        (QString i_name) { name_ = i_name; }
-    void RemoveAllTasksFromList (void)           { list_.clear();  }
+    // ReserveTasks()
+    // Make room for the input number of tasks up front, e.g. before loading a file
+    void ReserveTasks(int);
+
+    // SetFileBuffer(), GetFileBuffer(), ReleaseFileBuffer(), TakeFileBuffer()
+    // The file a list was loaded from, while descriptions are left in it; release it by reading them (returning how
+    // many couldn't be), or take another list's for them
+    void                                         SetFileBuffer     (std::shared_ptr<const TaskFileBuffer> i_buffer) { file_buffer_ = std::move(i_buffer); }
+    const std::shared_ptr<const TaskFileBuffer>& GetFileBuffer     (void) const                                    { return file_buffer_;               }
+    int                                          ReleaseFileBuffer (void);
+    void                                         TakeFileBuffer    (TaskList& i_source);
+
+    // SetChangeLogging(), TakeChanges()
+    // While logging is on (off by default), every change made through the list is recorded for saving (see TaskJournal)
+    void                           SetChangeLogging (bool i_flag) { change_logging_ = i_flag; if (!i_flag) ClearDirty();                      }
+    bool                           IsChangeLogging  (void) const  { return change_logging_;                                                   }
+    const std::vector<TaskChange>& GetChanges       (void) const  { return changes_;                                                          }
+    std::vector<TaskChange>        TakeChanges      (void)        { std::vector<TaskChange> o_changes; o_changes.swap(changes_); ClearDirty(); return o_changes; }
+
+    // IsTaskListDirty(), IsTaskDirty(), SetTaskListDirty()
+    // Whether the list or a task has changes not taken for saving yet; a list can also be marked dirty as a whole
+    bool                           IsTaskListDirty  (void) const              { return dirty_ || !changes_.empty();                   }
+    bool                           IsTaskDirty      (const Task* i_ptr) const { return dirty_tasks_.count(i_ptr->GetTaskId()) != 0; }
+    void                           SetTaskListDirty (void)                    { dirty_ = true;                                        }
+
+    // SetEventHandler()
+    // Called with every change to the list as it happens (bulk changes report one kReset); nullptr to stop
+    void SetEventHandler (std::function<void(const TaskEvent&)> i_handler) { event_handler_ = std::move(i_handler); }
+
+    // SetJournalId(), GetJournalId()
+    // ID of the change journal kept next to the file the list is saved in; 0 if the file has none yet
+    void     SetJournalId (uint64_t i_id) { journal_id_ = i_id; }
+    uint64_t GetJournalId (void) const    { return journal_id_; }
+
+    void SetTaskListName        (const QString& i_name) { name_ = i_name;            }
+    void SetTaskListName        (QString&&      i_name) { name_ = std::move(i_name); }
+    void RemoveAllTasksFromList (void);
+
+    // SetTaskName()
+    // Renames a task in the list, keeping the name index in sync
+    void SetTaskName(Task*, const QString&);
+
+    // SetTaskDescription(), SetTaskDeadline()
+    // Set the description/deadline (invalid QDateTime to clear) of a task in the list
+    // Prefer these to the Task setters while the list is logging changes, so the change is recorded
+    void SetTaskDescription (Task*, const QString&);
+    void SetTaskDeadline    (Task*, const QDateTime&);
+
+    // SetTaskCompleted()
+    // Sets/clears (invalid QDateTime) the completion time of a task in the list
+    // Updates the incomplete prerequisite count of each of its dependents
+    void SetTaskCompleted(Task*, const QDateTime&);
+
+    // AddTaskPrereq(), RemoveTaskPrereq()
+    // Link/unlink a prerequisite to a task; the task becomes/stops being a dependent of the prerequisite
+    // Does nothing if input is invalid
+    void AddTaskPrereq    (Task* i_task, Task* i_prereq);
+    void RemoveTaskPrereq (Task* i_task, Task* i_prereq);
 
     // SetTaskPrereqFromList(), SetTaskDependFromList()
     // Remove the prerequistes/dependents (string list) from the given task (string)
     // Ignores items in list which are not prerequistes/dependents of the given task
-    void SetTaskPrereqFromList(QString, QStringList);
-    void SetTaskDependFromList(QString, QStringList);
+    void SetTaskPrereqFromList(const QString&, const QStringList&);
+    void SetTaskDependFromList(const QString&, const QStringList&);
 
     // AddTaskToList()
     // Creates a new task for the list, constructed using the input information
+    // Arguments are taken by value and moved into the task, so temporaries aren't copied
     Task* AddTaskToList(QString, QString = QString(), QDateTime = QDateTime(), QDateTime = QDateTime());
 
     // RemoveTaskFromList()
     // Removes task from the list, matched by either name or pointer
     void  RemoveTaskFromList(Task*);
-    void  RemoveTasksFromList(std::vector<Task*>);
+    void  RemoveTasksFromList(const std::vector<Task*>&);
+
+    // SyncTaskList()
+    // Make the list match another (e.g. its file, read again), matching tasks by name; counts the tasks affected
+    // Only tasks that differ are touched, so pointers to unchanged tasks stay valid
+    void  SyncTaskList(TaskList& i_source, int* o_added, int* o_changed, int* o_removed);
 
 protected:
 
     // Data
     QString                            name_;
-    std::vector<std::unique_ptr<Task>> list_;  // Shared pointers for copying/searching qt objects
-
-    void DisconnectPrereqDepend(Task*);
+    SlabPool<Task>                     pool_;        // Storage for every task in the list; released in bulk with the list
+    std::vector<Task*>                 list_;        // Indexed by task ID; nullptr for IDs of removed tasks
+    Task::IdVector                     free_ids_;    // IDs of removed tasks, reused by new tasks to keep IDs dense
+    TaskGraph                          graph_;       // Prerequisite/dependent links between task IDs
+    QMultiHash<QString, Task*>         name_index_;  // Name -> task lookup; multi in case a loaded file has duplicate names
+    QStringList                        all_names_;        // Cached result of GetAllTaskNamesFromList()
+    bool                               all_names_valid_;
+    std::shared_ptr<const TaskFileBuffer> file_buffer_;   // Backing for descriptions not converted yet, see SetFileBuffer()
+    bool                               change_logging_;
+    std::vector<TaskChange>            changes_;          // Changes since the last TakeChanges(), if logging
+    std::unordered_set<Task::Id>       dirty_tasks_;      // Tasks changed since the last TakeChanges(), if logging
+    bool                               dirty_;            // Set by SetTaskListDirty()
+    void                               ClearDirty (void) { changes_.clear(); dirty_tasks_.clear(); dirty_ = false; }
+    uint64_t                           journal_id_;
+    std::function<void(const TaskEvent&)> event_handler_;
+    void Notify (TaskEvent::Type i_type, Task::Id i_id = 0) { if (event_handler_) event_handler_(TaskEvent{i_type, i_id}); }
+
+    // Completion state tracking, indexed by task ID
+    std::vector<uint32_t>              incomplete_prereq_;  // Number of incomplete direct prerequisites
+    std::vector<uint8_t>               state_;              // TaskState of each task
+    std::vector<uint32_t>              state_pos_;          // Position of each task within state_members_[state_]
+    Task::IdVector                     state_members_[3];   // IDs of all tasks in each TaskState
+
+    // Closure caches for GetChainedPrereq()/GetChainedDepend(), valid while graph_version_ == chain_cache_version_
+    uint64_t                                         graph_version_;
+    uint64_t                                         chain_cache_version_;
+    std::unordered_map<Task::Id, Task::IdVector>     chained_prereq_cache_;
+    std::unordered_map<Task::Id, Task::IdVector>     chained_depend_cache_;
+    std::vector<uint32_t>                            visit_mark_;   // Per-ID visited stamp, so traversals don't clear a visited set
+    uint32_t                                         visit_stamp_;
+
+    // Transitive closure of graph_, updated as links change and rebuilt lazily once invalid; false if the list is too large
+    TaskReachability                                 reachability_;
+    bool EnsureReachability (void) { if (!reachability_.IsValid() && list_.size() <= TaskReachability::MAX_CAPACITY) reachability_.Rebuild(graph_, list_.size()); return reachability_.IsValid(); }
+
+    // Get a chain from the cache, collecting it first if needed
+    // Follow prerequisites (or dependents) from a task, collecting every task reached
+    const Task::IdVector& GetCachedChain (Task::Id, bool i_prereq);
+    void                  CollectChain   (Task::Id, bool i_prereq, Task::IdVector* o_chain);
+
+    // Record a change to a task (under its current name) and mark it dirty, if logging
+    void LogChange (const Task* i_task, TaskChange::Type i_type, const QString& i_text = QString(), const QDateTime& i_time = QDateTime())
+    {
+        if (!change_logging_) return;
+        changes_.push_back(TaskChange{i_type, i_task->GetTaskName(), i_text, i_time});
+        dirty_tasks_.insert(i_task->GetTaskId());
+    }
+
+    // Move a task to the state implied by its completion and prerequisite count, if it changed
+    void UpdateTaskState (Task::Id, bool i_new = false);
+    void RemoveTaskState (Task::Id);
+
+    // Compare/copy a task's description with one from another list, for SyncTaskList()
+    static bool IsSameTaskDescription (const Task* i_task, const Task* i_source);
+    static void TakeTaskDescription   (Task* io_task, const Task* i_source);
 };
 
 #endif // TASK_H
@@ -0,0 +1,1296 @@
+//    This file is part of Telos
+//    Copyright (c) 2021, Cynical Tech Humor LLC
+
+//    Telos is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    Telos is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with Telos.  If not, see <https://www.gnu.org/licenses/>.
+
+//    Source code is available at:
+//    <https://github.com/CynicalTechHumor/Telos>
+
+#include "taskfile.h"
+
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TELOS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// TaskFileBuffer
+
+std::shared_ptr<TaskFileBuffer> TaskFileBuffer::Open(const QString& i_path, QString* o_error)
+{
+    std::shared_ptr<TaskFileBuffer> o_buffer(new TaskFileBuffer());
+    o_buffer->file_.setFileName(i_path);
+    if (!o_buffer->file_.open(QIODevice::ReadOnly))
+    {
+        *o_error = o_buffer->file_.errorString();
+        return nullptr;
+    }
+
+    // Empty files can't be mapped, and mapping may be unsupported; fall back to reading the file
+    qint64 size = o_buffer->file_.size();
+    o_buffer->size_     = size;
+    o_buffer->modified_ = QFileInfo(i_path).lastModified().toMSecsSinceEpoch();
+    if (size > 0) o_buffer->map_ = o_buffer->file_.map(0, size);
+    if (o_buffer->map_)
+        o_buffer->data_ = std::string_view(reinterpret_cast<const char*>(o_buffer->map_), static_cast<size_t>(size));
+    else
+    {
+        o_buffer->copy_ = o_buffer->file_.readAll();
+        o_buffer->data_ = std::string_view(o_buffer->copy_.constData(), static_cast<size_t>(o_buffer->copy_.size()));
+        o_buffer->file_.close();
+    }
+
+    // A compressed file is inflated into memory, after which the file itself isn't needed
+    if (TaskFileBinary::IsCompressed(o_buffer->data_))
+    {
+        QByteArray inflated = TaskFileBinary::Inflate(o_buffer->data_, o_error);
+        if (inflated.isEmpty()) return nullptr;
+        if (o_buffer->map_) o_buffer->file_.unmap(o_buffer->map_);
+        o_buffer->map_        = nullptr;
+        o_buffer->file_.close();
+        o_buffer->copy_       = std::move(inflated);
+        o_buffer->data_       = std::string_view(o_buffer->copy_.constData(), static_cast<size_t>(o_buffer->copy_.size()));
+        o_buffer->compressed_ = true;
+    }
+    return o_buffer;
+}
+
+TaskFileBuffer::~TaskFileBuffer()
+{
+    if (map_) file_.unmap(map_);
+}
+
+void TaskFileBuffer::Unmap(void)
+{
+    if (!map_) return;
+    file_.unmap(map_);
+    file_.close();
+    map_  = nullptr;
+    data_ = std::string_view();
+}
+
+bool TaskFileBuffer::Read(const TaskDescriptionSource& i_source, QByteArray* o_bytes, QFile* io_file) const
+{
+    if (!data_.empty())
+    {
+        *o_bytes = QByteArray(data_.data() + i_source.offset, static_cast<qsizetype>(i_source.length));
+        return true;
+    }
+
+    // The file is only read if it's still the one opened: a save replaces it, so its size or time changes
+    QFile  local_file;
+    QFile& file = io_file ? *io_file : local_file;
+    if (!file.isOpen())
+    {
+        file.setFileName(GetPath());
+        if (!file.open(QIODevice::ReadOnly)) return false;
+        if (file.size() != size_ || QFileInfo(GetPath()).lastModified().toMSecsSinceEpoch() != modified_)
+        {
+            file.close();
+            return false;
+        }
+    }
+    if (!file.seek(i_source.offset)) return false;
+    *o_bytes = file.read(i_source.length);
+    return o_bytes->size() == static_cast<qsizetype>(i_source.length);
+}
+
+// TaskListSnapshot
+
+TaskListSnapshot::TaskListSnapshot(const TaskList& i_list)
+{
+    // Number the tasks densely in ID order
+    name        = i_list.GetTaskListName();
+    file_buffer = i_list.GetFileBuffer();
+    tasks.reserve(i_list.GetTaskListSize());
+    std::vector<uint32_t> index_of;
+    for (Task* i : i_list.GetTaskRange())
+    {
+        if (index_of.size() <= i->GetTaskId()) index_of.resize(i->GetTaskId() + 1, 0);
+        index_of[i->GetTaskId()] = static_cast<uint32_t>(tasks.size());
+        tasks.push_back(Item{i->GetTaskName(),
+                             i->GetTaskDescriptionSource().length ? QString() : i->GetTaskDescription(),
+                             i->GetTaskDescriptionSource(),
+                             i->GetTaskDeadline(),
+                             i->GetTaskCompleted()});
+    }
+    for (Task* i : i_list.GetTaskRange())
+    {
+        for (Task::Id j : i_list.GetTaskPrereqIds(i))
+            links.emplace_back(index_of[i->GetTaskId()], index_of[j]);
+        for (Task::Id j : i_list.GetTaskDependIds(i))
+            depends.emplace_back(index_of[i->GetTaskId()], index_of[j]);
+    }
+}
+
+// TaskFileBinary
+// All integers are little-endian; sections follow each other without padding:
+//   Header (48 bytes):  magic[8], uint16 version, uint16 flags, uint32 task count, uint32 edge count,
+//                       uint32 string count, uint64 string data size, uint64 journal ID, uint64 journal offset
+//   Tasks (24 bytes):   uint32 name string, uint32 description string (NO_STRING if empty),
+//                       int64 deadline, int64 completed (ms since epoch, NO_TIME if not set)
+//   Edges (8 bytes):    uint32 task index, uint32 prerequisite index - each link is stored once
+//   Strings (8 bytes):  uint32 offset into the string data, uint32 length in bytes
+//   String data:        UTF-8 text; string 0 is the list name
+// Version 1 headers are 32 bytes, without the journal ID/offset (see TaskJournal)
+// With FLAG_COMPRESSED, everything after the header is one qCompress() block; the header's sizes are once inflated
+
+// PNG-style magic: a non-ASCII byte, the format name, then bytes that catch text-mode newline/EOF conversion
+const char TaskFileBinary::MAGIC[8] = {'\x89', 'T', 'L', 'S', '\r', '\n', '\x1a', '\n'};
+
+bool TaskFileBinary::IsBinary(std::string_view i_data)
+{
+    return i_data.size() >= sizeof(MAGIC) && std::memcmp(i_data.data(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool TaskFileBinary::IsCompressed(std::string_view i_data)
+{
+    return GetHeaderSize(i_data) && (qFromLittleEndian<uint16_t>(i_data.data() + 10) & FLAG_COMPRESSED);
+}
+
+QByteArray TaskFileBinary::Inflate(std::string_view i_data, QString* o_error)
+{
+    size_t     header_size = GetHeaderSize(i_data);
+    QByteArray o_data      = qUncompress(reinterpret_cast<const uchar*>(i_data.data() + header_size), static_cast<qsizetype>(i_data.size() - header_size));
+    if (o_data.isEmpty())
+    {
+        *o_error = "File is compressed, but the compressed data is corrupt";
+        return QByteArray();
+    }
+    o_data.prepend(i_data.data(), static_cast<qsizetype>(header_size));
+    qToLittleEndian<uint16_t>(qFromLittleEndian<uint16_t>(o_data.constData() + 10) & ~FLAG_COMPRESSED, o_data.data() + 10);
+    return o_data;
+}
+
+size_t TaskFileBinary::GetHeaderSize(std::string_view i_data)
+{
+    if (!IsBinary(i_data) || i_data.size() < HEADER_SIZE_V1) return 0;
+    size_t header_size = qFromLittleEndian<uint16_t>(i_data.data() + 8) >= 2 ? HEADER_SIZE : HEADER_SIZE_V1;
+    return i_data.size() >= header_size ? header_size : 0;
+}
+
+bool TaskFileBinary::GetJournalPosition(std::string_view i_data, uint64_t* o_id, uint64_t* o_offset)
+{
+    size_t header_size = GetHeaderSize(i_data);
+    if (!header_size) return false;
+    *o_id     = header_size == HEADER_SIZE ? qFromLittleEndian<uint64_t>(i_data.data() + 32) : 0;
+    *o_offset = header_size == HEADER_SIZE ? qFromLittleEndian<uint64_t>(i_data.data() + 40) : 0;
+    return true;
+}
+
+QByteArray TaskFileBinary::Write(const TaskListSnapshot& i_snapshot, uint64_t i_journal_id, uint64_t i_journal_offset, bool i_compress)
+{
+    // Count what goes in each section
+    const std::vector<TaskListSnapshot::Item>& tasks        = i_snapshot.tasks;
+    uint32_t                                   edge_count   = static_cast<uint32_t>(i_snapshot.links.size()),
+                                               string_count = 1;
+    for (const TaskListSnapshot::Item& i : tasks)
+        string_count += (i.description.isEmpty() && !i.description_source.length) ? 1 : 2;
+
+    // Fixed-size sections are filled in place; string data is appended after them
+    size_t     tasks_at   = HEADER_SIZE,
+               edges_at   = tasks_at + tasks.size() * TASK_SIZE,
+               strings_at = edges_at + size_t(edge_count) * EDGE_SIZE,
+               data_at    = strings_at + size_t(string_count) * STRING_SIZE;
+    QByteArray data(static_cast<qsizetype>(data_at), '\0');
+    char*      out        = data.data();
+
+    // Add UTF-8 bytes (or a string) to the string data, returning the index
+    // Offsets are 32-bit, which limits the text of one list to 4 GiB
+    uint32_t next_string = 0;
+    auto AddBytes = [&](std::string_view i_utf8) -> uint32_t
+    {
+        size_t offset = data.size() - data_at;
+        data.append(i_utf8.data(), static_cast<qsizetype>(i_utf8.size()));
+        out = data.data();
+        qToLittleEndian<uint32_t>(static_cast<uint32_t>(offset),        out + strings_at + next_string * STRING_SIZE);
+        qToLittleEndian<uint32_t>(static_cast<uint32_t>(i_utf8.size()), out + strings_at + next_string * STRING_SIZE + 4);
+        return next_string++;
+    };
+    auto AddString = [&](const QString& i_text) -> uint32_t
+    {
+        QByteArray utf8 = i_text.toUtf8();
+        return AddBytes(std::string_view(utf8.constData(), static_cast<size_t>(utf8.size())));
+    };
+    AddString(i_snapshot.name);
+
+    // Task records; descriptions that were never read are copied straight from the file they were loaded from
+    // Returns an empty array if that file can't be read any more
+    QFile      source_file;
+    QByteArray source_bytes;
+    for (size_t i=0; i<tasks.size(); ++i)
+    {
+        const TaskListSnapshot::Item& task = tasks[i];
+        if (task.description_source.length && !task.description_source.file->Read(task.description_source, &source_bytes, &source_file))
+            return QByteArray();
+        uint32_t name        = AddString(task.name),
+                 description = task.description_source.length ? AddBytes(std::string_view(source_bytes.constData(), static_cast<size_t>(source_bytes.size())))
+                             : !task.description.isEmpty()    ? AddString(task.description)
+                                                              : NO_STRING;
+        char*    record      = out + tasks_at + i * TASK_SIZE;
+        qToLittleEndian<uint32_t>(name,        record);
+        qToLittleEndian<uint32_t>(description, record + 4);
+        qToLittleEndian<int64_t> (task.deadline.isValid()  ? task.deadline.toMSecsSinceEpoch()  : NO_TIME, record + 8);
+        qToLittleEndian<int64_t> (task.completed.isValid() ? task.completed.toMSecsSinceEpoch() : NO_TIME, record + 16);
+    }
+
+    // Each task's prerequisites (in the order they were linked) as index pairs
+    for (size_t i=0; i<i_snapshot.links.size(); ++i)
+    {
+        qToLittleEndian<uint32_t>(i_snapshot.links[i].first,  out + edges_at + i * EDGE_SIZE);
+        qToLittleEndian<uint32_t>(i_snapshot.links[i].second, out + edges_at + i * EDGE_SIZE + 4);
+    }
+
+    // Header last, once the string data size is known
+    std::memcpy(out, MAGIC, sizeof(MAGIC));
+    qToLittleEndian<uint16_t>(VERSION,                               out + 8);
+    qToLittleEndian<uint16_t>(0,                                     out + 10);
+    qToLittleEndian<uint32_t>(static_cast<uint32_t>(tasks.size()),   out + 12);
+    qToLittleEndian<uint32_t>(edge_count,                            out + 16);
+    qToLittleEndian<uint32_t>(string_count,                          out + 20);
+    qToLittleEndian<uint64_t>(static_cast<uint64_t>(data.size() - data_at), out + 24);
+    qToLittleEndian<uint64_t>(i_journal_id,                          out + 32);
+    qToLittleEndian<uint64_t>(i_journal_offset,                      out + 40);
+    if (!i_compress) return data;
+
+    // Compressed: the header stays as it is (but flagged), followed by everything else as one block
+    QByteArray o_data = qCompress(reinterpret_cast<const uchar*>(data.constData() + HEADER_SIZE), data.size() - static_cast<qsizetype>(HEADER_SIZE));
+    o_data.prepend(data.constData(), static_cast<qsizetype>(HEADER_SIZE));
+    qToLittleEndian<uint16_t>(FLAG_COMPRESSED, o_data.data() + 10);
+    return o_data;
+}
+
+QString TaskFileBinary::WriteFile(const QString& i_path, const TaskListSnapshot& i_snapshot, uint64_t i_journal_id, uint64_t i_journal_offset, bool i_compress)
+{
+    // QSaveFile writes to a temporary file and renames it over the old one on commit,
+    // so a failed or interrupted save leaves the previous file as it was
+    QSaveFile file(i_path);
+    if (!file.open(QIODevice::WriteOnly)) return file.errorString();
+    QByteArray data = Write(i_snapshot, i_journal_id, i_journal_offset, i_compress);
+    if (data.isEmpty())
+    {
+        file.cancelWriting();
+        return "Descriptions couldn't be read from the file the list was loaded from, as it has changed since";
+    }
+    if (file.write(data) != data.size())
+    {
+        QString error = file.errorString();
+        file.cancelWriting();
+        return error;
+    }
+    if (!file.commit()) return file.errorString();
+    return QString();
+}
+
+std::unique_ptr<TaskList> TaskFileBinary::Read(std::string_view i_data, QString* o_error, std::shared_ptr<const TaskFileBuffer> i_backing)
+{
+    const char* in          = i_data.data();
+    size_t      header_size = GetHeaderSize(i_data);
+    if (!header_size)
+    {
+        *o_error = "File is not a binary task list";
+        return nullptr;
+    }
+    if (qFromLittleEndian<uint16_t>(in + 8) > VERSION)
+    {
+        *o_error = "File was saved by a newer version of Telos";
+        return nullptr;
+    }
+    if (qFromLittleEndian<uint16_t>(in + 10) & FLAG_COMPRESSED)
+    {
+        *o_error = "File is still compressed";
+        return nullptr;
+    }
+
+    // Sections must exactly fill the file (sizes are checked in 64 bits, so corrupt counts can't overflow)
+    uint64_t task_count   = qFromLittleEndian<uint32_t>(in + 12),
+             edge_count   = qFromLittleEndian<uint32_t>(in + 16),
+             string_count = qFromLittleEndian<uint32_t>(in + 20),
+             data_size    = qFromLittleEndian<uint64_t>(in + 24),
+             tasks_at     = header_size,
+             edges_at     = tasks_at   + task_count   * TASK_SIZE,
+             strings_at   = edges_at   + edge_count   * EDGE_SIZE,
+             data_at      = strings_at + string_count * STRING_SIZE;
+    if (string_count == 0 || data_size > i_data.size() || data_at != i_data.size() - data_size)
+    {
+        *o_error = "File is truncated or corrupt";
+        return nullptr;
+    }
+
+    // Looks up a string by index; false if the index or its extent is out of range
+    auto GetString = [&](uint32_t i_index, std::string_view* o_text) -> bool
+    {
+        if (i_index >= string_count) return false;
+        uint64_t offset = qFromLittleEndian<uint32_t>(in + strings_at + i_index * STRING_SIZE),
+                 length = qFromLittleEndian<uint32_t>(in + strings_at + i_index * STRING_SIZE + 4);
+        if (offset + length > data_size) return false;
+        *o_text = std::string_view(in + data_at + offset, length);
+        return true;
+    };
+    auto ToDateTime = [](int64_t i_msecs) { return i_msecs == NO_TIME ? QDateTime() : QDateTime::fromMSecsSinceEpoch(i_msecs); };
+
+    std::string_view list_name;
+    if (!GetString(0, &list_name) || list_name.empty())
+    {
+        *o_error = "File has no task list name";
+        return nullptr;
+    }
+    std::unique_ptr<TaskList> o_list = std::make_unique<TaskList>(TaskFileReader::ToString(list_name));
+    o_list->ReserveTasks(static_cast<int>(task_count));
+    bool lazy = i_backing && i_backing->GetData().data() == i_data.data() && i_data.size() <= UINT32_MAX;
+
+    // Tasks; descriptions are only converted now if there is no backing buffer to leave them in
+    std::vector<Task*> tasks(task_count, nullptr);
+    for (uint64_t i=0; i<task_count; ++i)
+    {
+        const char*      record      = in + tasks_at + i * TASK_SIZE;
+        uint32_t         description = qFromLittleEndian<uint32_t>(record + 4);
+        std::string_view name_text, description_text;
+        if (!GetString(qFromLittleEndian<uint32_t>(record), &name_text) || name_text.empty()
+         || (description != NO_STRING && !GetString(description, &description_text)))
+        {
+            *o_error = "Task " + QString::number(i) + " refers to a missing string";
+            return nullptr;
+        }
+        tasks[i] = o_list->AddTaskToList(TaskFileReader::ToString(name_text),
+                                         lazy ? QString() : TaskFileReader::ToString(description_text),
+                                         ToDateTime(qFromLittleEndian<int64_t>(record + 8)),
+                                         ToDateTime(qFromLittleEndian<int64_t>(record + 16)));
+        if (lazy && !description_text.empty())
+            tasks[i]->SetTaskDescriptionSource(TaskDescriptionSource{i_backing.get(), static_cast<uint32_t>(description_text.data() - in),
+                                                                     static_cast<uint32_t>(description_text.size())});
+    }
+
+    // Prerequisite links, in the order they were saved
+    for (uint64_t i=0; i<edge_count; ++i)
+    {
+        uint32_t task   = qFromLittleEndian<uint32_t>(in + edges_at + i * EDGE_SIZE),
+                 prereq = qFromLittleEndian<uint32_t>(in + edges_at + i * EDGE_SIZE + 4);
+        if (task >= task_count || prereq >= task_count)
+        {
+            *o_error = "Prerequisite link " + QString::number(i) + " refers to a missing task";
+            return nullptr;
+        }
+        o_list->AddTaskPrereq(tasks[task], tasks[prereq]);
+    }
+    if (lazy) o_list->SetFileBuffer(std::move(i_backing));
+    return o_list;
+}
+
+// TaskJournal
+//   Header (24 bytes):  magic[8], uint64 journal ID, uint64 base offset
+//   Records:            uint32 size of the rest of the record, uint8 TaskChange::Type,
+//                       uint32 name length, name (UTF-8), uint32 text length, text (UTF-8), int64 time (ms, NO_TIME if invalid)
+// Records are addressed by the base offset plus their position after the header
+// A .dat file records the journal that continues it and how far it already includes it, so compaction writes the
+// .dat file first and trims the journal after; a journal with another ID is left over from an older file
+
+const char TaskJournal::MAGIC[8] = {'\x89', 'T', 'L', 'J', '\r', '\n', '\x1a', '\n'};
+
+uint64_t TaskJournal::NewId(void)
+{
+    uint64_t o_id = 0;
+    while (!o_id) o_id = QRandomGenerator::global()->generate64();
+    return o_id;
+}
+
+QByteArray TaskJournal::WriteHeader(uint64_t i_id, uint64_t i_base)
+{
+    QByteArray o_header(static_cast<qsizetype>(HEADER_SIZE), '\0');
+    std::memcpy(o_header.data(), MAGIC, sizeof(MAGIC));
+    qToLittleEndian<uint64_t>(i_id,   o_header.data() + 8);
+    qToLittleEndian<uint64_t>(i_base, o_header.data() + 16);
+    return o_header;
+}
+
+bool TaskJournal::ReadHeader(std::string_view i_data, uint64_t* o_id, uint64_t* o_base)
+{
+    if (i_data.size() < HEADER_SIZE || std::memcmp(i_data.data(), MAGIC, sizeof(MAGIC)) != 0) return false;
+    *o_id   = qFromLittleEndian<uint64_t>(i_data.data() + 8);
+    *o_base = qFromLittleEndian<uint64_t>(i_data.data() + 16);
+    return true;
+}
+
+QByteArray TaskJournal::WriteChanges(const std::vector<TaskChange>& i_changes)
+{
+    QByteArray o_data;
+    for (const TaskChange& i : i_changes)
+    {
+        QByteArray name   = i.name.toUtf8(),
+                   text   = i.text.toUtf8();
+        uint32_t   length = static_cast<uint32_t>(1 + 4 + name.size() + 4 + text.size() + 8);
+        qsizetype  at     = o_data.size();
+        o_data.resize(at + 4 + length);
+        char* out = o_data.data() + at;
+        qToLittleEndian<uint32_t>(length,                               out);
+        out[4] = static_cast<char>(i.type);
+        qToLittleEndian<uint32_t>(static_cast<uint32_t>(name.size()),   out + 5);
+        std::memcpy(out + 9, name.constData(), name.size());
+        out += 9 + name.size();
+        qToLittleEndian<uint32_t>(static_cast<uint32_t>(text.size()),   out);
+        std::memcpy(out + 4, text.constData(), text.size());
+        qToLittleEndian<int64_t> (i.time.isValid() ? i.time.toMSecsSinceEpoch() : TaskFileBinary::NO_TIME, out + 4 + text.size());
+    }
+    return o_data;
+}
+
+bool TaskJournal::Append(const QString& i_path, uint64_t i_id, const std::vector<TaskChange>& i_changes, uint64_t* o_end, QString* o_error)
+{
+    QFile file(i_path);
+    if (!file.open(QIODevice::ReadWrite))
+    {
+        *o_error = file.errorString();
+        return false;
+    }
+
+    // A new journal starts at offset 0; an existing one must belong to the same .dat file
+    uint64_t id   = i_id,
+             base = 0;
+    if (file.size() == 0)
+    {
+        if (file.write(WriteHeader(i_id, 0)) != static_cast<qint64>(HEADER_SIZE))
+        {
+            *o_error = file.errorString();
+            return false;
+        }
+    }
+    else
+    {
+        QByteArray header = file.read(HEADER_SIZE);
+        if (!ReadHeader(std::string_view(header.constData(), static_cast<size_t>(header.size())), &id, &base) || id != i_id)
+        {
+            *o_error = "Journal belongs to another version of the file";
+            return false;
+        }
+    }
+
+    QByteArray records = WriteChanges(i_changes);
+    if (!file.seek(file.size()) || file.write(records) != records.size() || !file.flush())
+    {
+        *o_error = file.errorString();
+        return false;
+    }
+    *o_end = base + static_cast<uint64_t>(file.size() - static_cast<qint64>(HEADER_SIZE));
+    return true;
+}
+
+bool TaskJournal::Replay(std::string_view i_data, uint64_t i_id, uint64_t i_from, uint64_t i_to, TaskList* io_list, int* o_rejected, bool* o_torn)
+{
+    uint64_t id, base;
+    if (!ReadHeader(i_data, &id, &base) || id != i_id) return false;
+    *o_rejected = 0;
+    *o_torn     = false;
+
+    const char* in  = i_data.data();
+    size_t      pos = HEADER_SIZE;
+    while (pos < i_data.size())
+    {
+        // Stop at a record cut short, e.g. by a crash while it was being appended
+        size_t remaining = i_data.size() - pos;
+        if (remaining < 4 || qFromLittleEndian<uint32_t>(in + pos) > remaining - 4)
+        {
+            *o_torn = true;
+            break;
+        }
+        uint64_t    offset = base + (pos - HEADER_SIZE);
+        uint32_t    length = qFromLittleEndian<uint32_t>(in + pos);
+        const char* record = in + pos + 4;
+        pos += 4 + size_t(length);
+        if (i_to && offset >= i_to) break;
+        if (offset < i_from)        continue;
+
+        // Fields (type, two length-prefixed strings, time: 17 bytes besides the text) must exactly fill the record
+        uint32_t name_length = length >= 17 ? qFromLittleEndian<uint32_t>(record + 1) : 0,
+                 text_length = 0;
+        if (length < 17 || name_length > length - 17
+         || (text_length = qFromLittleEndian<uint32_t>(record + 5 + name_length)) != length - 17 - name_length
+         || static_cast<uint8_t>(record[0]) >= TaskChange::kTypeCount)
+        {
+            ++*o_rejected;
+            continue;
+        }
+        int64_t    time = qFromLittleEndian<int64_t>(record + 9 + name_length + text_length);
+        TaskChange change{static_cast<TaskChange::Type>(record[0]),
+                          TaskFileReader::ToString(std::string_view(record + 5, name_length)),
+                          TaskFileReader::ToString(std::string_view(record + 9 + name_length, text_length)),
+                          time == TaskFileBinary::NO_TIME ? QDateTime() : QDateTime::fromMSecsSinceEpoch(time)};
+        if (!ApplyChange(change, io_list)) ++*o_rejected;
+    }
+    return true;
+}
+
+bool TaskJournal::ApplyChange(const TaskChange& i_change, TaskList* io_list)
+{
+    // Every change but a creation needs its task to exist; links need the prerequisite as well
+    Task* task = io_list->GetPtrFromTaskList(i_change.name);
+    if (i_change.type == TaskChange::kCreate)
+    {
+        if (task || i_change.name.isEmpty()) return false;
+        io_list->AddTaskToList(i_change.name);
+        return true;
+    }
+    if (!task) return false;
+
+    switch (i_change.type)
+    {
+    case TaskChange::kRename:
+        if (i_change.text.isEmpty() || io_list->CheckDuplicateTaskName(i_change.text, task)) return false;
+        io_list->SetTaskName(task, i_change.text);
+        return true;
+    case TaskChange::kDescription:
+        io_list->SetTaskDescription(task, i_change.text);
+        return true;
+    case TaskChange::kDeadline:
+        io_list->SetTaskDeadline(task, i_change.time);
+        return true;
+    case TaskChange::kCompleted:
+        io_list->SetTaskCompleted(task, i_change.time);
+        return true;
+    case TaskChange::kLink:
+    case TaskChange::kUnlink:
+    {
+        Task* prereq = io_list->GetPtrFromTaskList(i_change.text);
+        if (!prereq || prereq == task) return false;
+        if (i_change.type == TaskChange::kLink) io_list->AddTaskPrereq   (task, prereq);
+        else                                    io_list->RemoveTaskPrereq(task, prereq);
+        return true;
+    }
+    case TaskChange::kRemove:
+        io_list->RemoveTaskFromList(task);
+        return true;
+    default:
+        return false;
+    }
+}
+
+QString TaskJournal::Compact(const QString& i_file_path, uint64_t i_id, uint64_t i_end, bool i_compress)
+{
+    // Read the .dat file without leaving descriptions in it, since it is about to be replaced
+    QString                         error;
+    uint64_t                        id, offset;
+    std::unique_ptr<TaskList>       list;
+    std::shared_ptr<TaskFileBuffer> file = TaskFileBuffer::Open(i_file_path, &error);
+    if (!file) return error;
+    if (!TaskFileBinary::GetJournalPosition(file->GetData(), &id, &offset) || id != i_id)
+        return "File was replaced since its journal was written";
+    list = TaskFileBinary::Read(file->GetData(), &error);
+    file.reset();
+    if (!list) return error;
+
+    // Apply the journal up to the end offset; anything appended after it stays in the journal
+    QFile journal(GetPath(i_file_path));
+    if (!journal.open(QIODevice::ReadOnly)) return journal.errorString();
+    QByteArray journal_data = journal.readAll();
+    journal.close();
+    int  rejected;
+    bool torn;
+    if (!Replay(std::string_view(journal_data.constData(), static_cast<size_t>(journal_data.size())), i_id, offset, i_end, list.get(), &rejected, &torn))
+        return "Journal belongs to another version of the file";
+
+    return TaskFileBinary::WriteFile(i_file_path, TaskListSnapshot(*list), i_id, i_end, i_compress);
+}
+
+bool TaskJournal::Trim(const QString& i_path, uint64_t i_id, uint64_t i_end, QString* o_error)
+{
+    QFile journal(i_path);
+    if (!journal.open(QIODevice::ReadOnly))
+    {
+        *o_error = journal.errorString();
+        return false;
+    }
+    QByteArray data = journal.readAll();
+    journal.close();
+
+    // Nothing to do if the journal was replaced since (e.g. by a full save), or already trimmed
+    uint64_t id, base;
+    if (!ReadHeader(std::string_view(data.constData(), static_cast<size_t>(data.size())), &id, &base) || id != i_id || i_end <= base)
+        return true;
+    uint64_t cut = HEADER_SIZE + (i_end - base);
+    if (cut > static_cast<uint64_t>(data.size()))
+    {
+        *o_error = "Journal is shorter than expected";
+        return false;
+    }
+
+    QSaveFile out(i_path);
+    if (!out.open(QIODevice::WriteOnly))
+    {
+        *o_error = out.errorString();
+        return false;
+    }
+    out.write(WriteHeader(i_id, i_end));
+    out.write(data.constData() + cut, data.size() - static_cast<qsizetype>(cut));
+    if (!out.commit())
+    {
+        *o_error = out.errorString();
+        return false;
+    }
+    return true;
+}
+
+// TaskFileLoad
+
+void TaskFileLoad::Read(bool i_journal)
+{
+    // Map the file into memory
+    std::shared_ptr<TaskFileBuffer> file = TaskFileBuffer::Open(path, &error);
+    if (!file)
+    {
+        error = "Failed to open file: " + error;
+        return;
+    }
+
+    // Read binary files directly; anything else is parsed as a legacy byte-delimited file
+    // Malformed legacy task records are skipped
+    std::string_view data           = file->GetData();
+    int              rejected_count = 0;
+    if (TaskFileBinary::IsBinary(data))
+        list = TaskFileBinary::Read(data, &error, file);
+    else
+    {
+        TaskFileReader reader(data);
+        list           = reader.ReadTaskList(file);
+        error          = reader.GetError();
+        rejected_count = reader.GetRejectedCount();
+    }
+    if (!list) return;
+    if (rejected_count)
+        warnings.append("Skipped " + QString::number(rejected_count) + " malformed task(s) in \"" + path + "\".");
+
+    // Descriptions are left in the file, read from it as needed; it's closed (so it can be replaced) once loaded
+    uint64_t journal_id, journal_offset;
+    bool     has_journal = i_journal && TaskFileBinary::GetJournalPosition(data, &journal_id, &journal_offset) && journal_id;
+    file->Unmap();
+
+    // Apply the changes saved to the journal since the file was written
+    // Later saves append to the journal only if it was read whole; otherwise the next save rewrites the file
+    if (!has_journal) return;
+    QFile journal(TaskJournal::GetPath(path));
+    if (!journal.exists())
+    {
+        if (journal_offset == 0) list->SetJournalId(journal_id);
+    }
+    else if (journal.open(QIODevice::ReadOnly))
+    {
+        QByteArray journal_data = journal.readAll();
+        int        rejected;
+        bool       torn;
+        if (TaskJournal::Replay(std::string_view(journal_data.constData(), static_cast<size_t>(journal_data.size())),
+                                journal_id, journal_offset, 0, list.get(), &rejected, &torn))
+        {
+            if (!torn) list->SetJournalId(journal_id);
+            if (rejected || torn)
+                warnings.append("Skipped " + QString::number(rejected + (torn ? 1 : 0)) + " unreadable change(s) in the journal of \"" + path + "\".");
+        }
+    }
+}
+
+void TaskFileLoad::ReadCsv(void)
+{
+    int rejected_count;
+    list = TaskFileCsv::ReadFile(path, 0, &error, &rejected_count);
+    if (list && rejected_count)
+        warnings.append("Skipped " + QString::number(rejected_count) + " malformed line(s) in \"" + path + "\".");
+}
+
+// TaskFileCsv
+// The quoted list name on the first line (left out of completed-task exports), then one line per task: name,
+// description, deadline, completed, prerequisites, dependents; quotes are doubled, names separated by ", "
+// and an empty field holds a single EMPTY byte (see TaskFileReader)
+
+QString TaskFileCsv::WriteFile(const QString&                  i_path,
+                               const TaskListSnapshot&         i_snapshot,
+                               char                            i_divide_field,
+                               bool                            i_completed_only,
+                               const std::function<bool(int)>& i_progress)
+{
+    QSaveFile file(i_path);
+    if (!file.open(QIODevice::WriteOnly)) return file.errorString();
+
+    // Links and dependents are grouped by task, so each task's prerequisites (and dependents) are a run of them,
+    // listed in the order they were linked
+    const size_t          task_count = i_snapshot.tasks.size();
+    std::vector<uint32_t> prereq_begin(task_count + 1, 0),
+                          depend_begin(task_count + 1, 0);
+    for (const std::pair<uint32_t, uint32_t>& i : i_snapshot.links)
+        ++prereq_begin[i.first + 1];
+    for (const std::pair<uint32_t, uint32_t>& i : i_snapshot.depends)
+        ++depend_begin[i.first + 1];
+    for (size_t i=0; i<task_count; ++i)
+    {
+        prereq_begin[i + 1] += prereq_begin[i];
+        depend_begin[i + 1] += depend_begin[i];
+    }
+
+    // Output is gathered in a chunk, which is written out (and progress reported) each time it fills
+    QByteArray chunk;
+    QString    error;
+    int        tasks_written = 0;
+    chunk.reserve(CHUNK_SIZE);
+    auto Flush = [&]()
+    {
+        if (file.write(chunk) != chunk.size()) error = file.errorString();
+        else if (i_progress && !i_progress(tasks_written)) error = "Cancelled";
+        chunk.clear();
+        return error.isEmpty();
+    };
+
+    // Quotes are doubled as the text is copied in, so each field is only scanned once
+    auto AppendText = [&chunk](const QByteArray& i_text)
+    {
+        const char* begin = i_text.constData(),
+                  * end   = begin + i_text.size();
+        for (const char* quote; (quote = static_cast<const char*>(std::memchr(begin, '"', end - begin)));
+             begin = quote + 1)
+        {
+            chunk.append(begin, quote - begin + 1);
+            chunk.append('"');
+        }
+        chunk.append(begin, end - begin);
+    };
+    auto AppendDate = [&chunk](const QDateTime& i_date)
+    {
+        if (i_date.isValid()) chunk.append(i_date.toString().toLocal8Bit());
+        else                  chunk.append(TaskFileReader::EMPTY);
+    };
+    auto AppendNames = [&](uint32_t i_begin, uint32_t i_end, auto i_task_at)
+    {
+        if (i_begin == i_end) chunk.append(TaskFileReader::EMPTY);
+        for (uint32_t i=i_begin; i<i_end; ++i)
+        {
+            if (i != i_begin) chunk.append(SUBFIELD);
+            AppendText(i_snapshot.tasks[i_task_at(i)].name.toLocal8Bit());
+        }
+    };
+    const char divide_field[3] = {'"', i_divide_field, '"'};
+
+    // First line is the list name: skipped if listing completed tasks
+    if (!i_completed_only)
+    {
+        chunk.append('"');
+        AppendText(i_snapshot.name.toLocal8Bit());
+        chunk.append('"');
+    }
+
+    // All subsequent lines are individual tasks; if exporting completed tasks, skip the incomplete ones
+    QFile      source_file;
+    QByteArray source_bytes;
+    for (size_t i=0; i<task_count; ++i)
+    {
+        const TaskListSnapshot::Item& task = i_snapshot.tasks[i];
+        if (i_completed_only && !task.completed.isValid()) continue;
+        if (task.description_source.length && !task.description_source.file->Read(task.description_source, &source_bytes, &source_file))
+        {
+            error = "Descriptions couldn't be read from the file the list was loaded from, as it has changed since";
+            break;
+        }
+
+        chunk.append('\n');
+        chunk.append('"');
+        AppendText(task.name.toLocal8Bit());
+        chunk.append(divide_field, 3);
+        if      (task.description_source.length) AppendText(QString::fromUtf8(source_bytes).toLocal8Bit());
+        else if (!task.description.isEmpty())     AppendText(task.description.toLocal8Bit());
+        else                                      chunk.append(TaskFileReader::EMPTY);
+        chunk.append(divide_field, 3);
+        AppendDate(task.deadline);
+        chunk.append(divide_field, 3);
+        AppendDate(task.completed);
+        chunk.append(divide_field, 3);
+        AppendNames(prereq_begin[i], prereq_begin[i + 1], [&](uint32_t j) { return i_snapshot.links[j].second; });
+        chunk.append(divide_field, 3);
+        AppendNames(depend_begin[i], depend_begin[i + 1], [&](uint32_t j) { return i_snapshot.depends[j].second; });
+        chunk.append('"');
+
+        tasks_written = static_cast<int>(i + 1);
+        if (chunk.size() >= CHUNK_SIZE && !Flush()) break;
+    }
+
+    // Only replace the file if everything was written
+    tasks_written = static_cast<int>(task_count);
+    if (error.isEmpty()) Flush();
+    if (!error.isEmpty())
+    {
+        file.cancelWriting();
+        return error;
+    }
+    if (!file.commit()) return file.errorString();
+    return QString();
+}
+
+std::unique_ptr<TaskList> TaskFileCsv::ReadFile(const QString& i_path, char i_divide_field, QString* o_error, int* o_rejected)
+{
+    *o_rejected = 0;
+    QFile file(i_path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        *o_error = file.errorString();
+        return nullptr;
+    }
+    QByteArray chunk        = file.read(CHUNK_SIZE);
+    char       divide_field = i_divide_field ? i_divide_field
+                                             : DetectDivideField(std::string_view(chunk.constData(), static_cast<size_t>(chunk.size())));
+
+    // Links are made once every task exists, since a line may name tasks further down the file
+    struct Link
+    {
+        Task*   task;
+        QString name;
+        bool    prereq;  // Name is a prerequisite of the task, otherwise a dependent
+    };
+    std::unique_ptr<TaskList> o_list = std::make_unique<TaskList>(QFileInfo(i_path).completeBaseName());
+    std::vector<Link>         links;
+    bool                      first_record = true;
+
+    // Fields are unescaped into one buffer per line, ending at the offsets in field_end
+    QByteArray       record;
+    std::vector<int> field_end;
+    auto Field = [&record, &field_end](size_t i) -> std::string_view
+    {
+        int              begin = i ? field_end[i - 1] : 0;
+        std::string_view field(record.constData() + begin, static_cast<size_t>(field_end[i] - begin));
+        return (field.size() == 1 && field[0] == TaskFileReader::EMPTY) ? std::string_view() : field;
+    };
+    auto ToString = [](std::string_view i_view) { return QString::fromLocal8Bit(i_view.data(), static_cast<qsizetype>(i_view.size())); };
+    auto ToDateTime = [&ToString](std::string_view i_view, bool* o_ok)
+    {
+        if (i_view.empty()) return QDateTime();
+        QString   text = ToString(i_view);
+        QDateTime date = QDateTime::fromString(text);
+        if (!date.isValid()) date = QDateTime::fromString(text, Qt::ISODate);
+        if (!date.isValid()) *o_ok = false;
+        return date;
+    };
+    auto AddLinks = [&](Task* i_task, std::string_view i_field, bool i_prereq)
+    {
+        while (!i_field.empty())
+        {
+            size_t end = i_field.find(SUBFIELD);
+            links.push_back(Link{i_task, ToString(i_field.substr(0, end)), i_prereq});
+            if (end == std::string_view::npos) break;
+            i_field.remove_prefix(end + sizeof(SUBFIELD) - 1);
+        }
+    };
+
+    // A line with one field names the list if it comes first; blank lines are skipped
+    // Lines with a task's six fields become tasks, unless a date can't be read
+    auto EndRecord = [&]()
+    {
+        field_end.push_back(record.size());
+        if (field_end.size() == 1)
+        {
+            if (first_record && !record.isEmpty()) o_list->SetTaskListName(ToString(Field(0)));
+            else if (!record.isEmpty())            ++*o_rejected;
+        }
+        else if (field_end.size() != TaskFileReader::kFieldCount)
+            ++*o_rejected;
+        else
+        {
+            bool      ok        = true;
+            QDateTime deadline  = ToDateTime(Field(TaskFileReader::kDeadline),  &ok),
+                      completed = ToDateTime(Field(TaskFileReader::kCompleted), &ok);
+            if (!ok || Field(TaskFileReader::kName).empty())
+                ++*o_rejected;
+            else
+            {
+                Task* task = o_list->AddTaskToList(ToString(Field(TaskFileReader::kName)), ToString(Field(TaskFileReader::kDescription)),
+                                                   std::move(deadline), std::move(completed));
+                AddLinks(task, Field(TaskFileReader::kPrereq), true);
+                AddLinks(task, Field(TaskFileReader::kDepend), false);
+            }
+        }
+        first_record = false;
+        record.resize(0);
+        field_end.clear();
+    };
+
+    // RFC 4180 parser, kept in its state across chunks: a quoted field may hold delimiters, line breaks and doubled quotes
+    // Text after a field's closing quote is kept, rather than rejecting the line
+    enum class State {kFieldStart, kUnquoted, kQuoted, kQuoteInQuoted};
+    State state = State::kFieldStart;
+    while (!chunk.isEmpty())
+    {
+        const char* p   = chunk.constData(),
+                  * end = p + chunk.size();
+        while (p < end)
+        {
+            if (state == State::kQuoted)
+            {
+                const char* quote = static_cast<const char*>(std::memchr(p, '"', end - p));
+                record.append(p, (quote ? quote : end) - p);
+                p = quote ? quote + 1 : end;
+                if (quote) state = State::kQuoteInQuoted;
+                continue;
+            }
+            if (state == State::kQuoteInQuoted && *p == '"')
+            {
+                record.append('"');
+                ++p;
+                state = State::kQuoted;
+                continue;
+            }
+            if (state == State::kFieldStart && *p == '"')
+            {
+                ++p;
+                state = State::kQuoted;
+                continue;
+            }
+
+            // Unquoted text runs to the next delimiter or line break
+            const char* q = p;
+            while (q < end && *q != divide_field && *q != '\n' && *q != '\r') ++q;
+            record.append(p, q - p);
+            p     = q;
+            state = State::kUnquoted;
+            if (p == end) break;
+            if (*p == divide_field) field_end.push_back(record.size());
+            else                    EndRecord();
+            state = State::kFieldStart;
+            ++p;
+        }
+        chunk = file.read(CHUNK_SIZE);
+    }
+    if (file.error() != QFileDevice::NoError)
+    {
+        *o_error = file.errorString();
+        return nullptr;
+    }
+    if (!record.isEmpty() || !field_end.empty() || state != State::kFieldStart) EndRecord();
+
+    // Link by name, prerequisites in the order they were exported, then dependents
+    // If names repeat, the last task with the name wins (as with TaskList::GetPtrFromTaskList())
+    // Every link is normally exported from both sides; links already made are ignored by the list
+    for (bool prereq : {true, false})
+        for (const Link& i : links)
+        {
+            Task* other = i.prereq == prereq ? o_list->GetPtrFromTaskList(i.name) : nullptr;
+            if (!other || other == i.task) continue;
+            if (prereq) o_list->AddTaskPrereq(i.task, other);
+            else        o_list->AddTaskPrereq(other, i.task);
+        }
+    return o_list;
+}
+
+char TaskFileCsv::DetectDivideField(std::string_view i_data)
+{
+    const char candidates[] = {',', '\t', ':'};
+    int        count[3]     = {0, 0, 0};
+    bool       quoted       = false;
+    for (size_t i=0; i<=i_data.size(); ++i)
+    {
+        char c = i < i_data.size() ? i_data[i] : '\n';
+        if (c == '"') quoted = !quoted;
+        if (quoted) continue;
+        if (c == '\n')
+        {
+            for (int j=0; j<3; ++j)
+                if (count[j] == TaskFileReader::kFieldCount - 1) return candidates[j];
+            std::fill(count, count + 3, 0);
+        }
+        for (int j=0; j<3; ++j)
+            if (c == candidates[j]) ++count[j];
+    }
+    return ',';
+}
+
+// TaskFileReader
+// The list name, then one record per task, each preceded by DIVIDE_TASK: six fields separated by DIVIDE_FIELD,
+// with prerequisite/dependent names separated by DIVIDE_SUBFIELD; an empty field is a single EMPTY byte
+
+TaskFileReader::TaskFileReader(std::string_view i_data)
+{
+    // The list name runs up to the first record (or the end of the file, for a list without tasks)
+    const char* begin = i_data.data();
+    end_              = begin + i_data.size();
+    pos_              = static_cast<const char*>(std::memchr(begin, DIVIDE_TASK, i_data.size()));
+    if (!pos_) pos_   = end_;
+    list_name_        = std::string_view(begin, pos_ - begin);
+    rejected_count_   = 0;
+}
+
+bool TaskFileReader::ReadRecord(Record* o_record)
+{
+    // pos_ is always at the DIVIDE_TASK starting the next record, or at the end of the buffer
+    while (pos_ != end_)
+    {
+        // Split the record at each DIVIDE_FIELD, stopping at the next DIVIDE_TASK
+        // Fields beyond the sixth are only counted, so an overlong record is still consumed whole
+        const char* field_begin = pos_ + 1;
+        int         field_count = 0;
+        for (;;)
+        {
+            const char* field_end = FindDelimiter(field_begin, end_);
+            if (field_count < kFieldCount)
+                o_record->field[field_count] = StripEmpty(std::string_view(field_begin, field_end - field_begin));
+            ++field_count;
+            if (field_end == end_ || *field_end == DIVIDE_TASK)
+            {
+                pos_ = field_end;
+                break;
+            }
+            field_begin = field_end + 1;
+        }
+
+        if (field_count == kFieldCount && !o_record->field[kName].empty()) return true;
+        ++rejected_count_;
+    }
+    return false;
+}
+
+std::unique_ptr<TaskList> TaskFileReader::ReadTaskList(std::shared_ptr<const TaskFileBuffer> i_backing)
+{
+    if (list_name_.empty())
+    {
+        error_ = "File does not begin with a task list name";
+        return nullptr;
+    }
+    std::unique_ptr<TaskList> o_list = std::make_unique<TaskList>(ToString(list_name_));
+
+    // Tokenize every record first, so the list can be sized once
+    std::vector<Record> records;
+    Record              record;
+    while (ReadRecord(&record))
+        records.push_back(record);
+    o_list->ReserveTasks(static_cast<int>(records.size()));
+    bool lazy = i_backing && i_backing->GetData().data() == list_name_.data() && i_backing->GetData().size() <= UINT32_MAX;
+
+    // Create the tasks; records with an unreadable deadline/completion date are rejected as well
+    // Prerequisites are matched by the raw name bytes, so names are only converted once, for the tasks themselves
+    // If names repeat, the last task with the name wins (as with TaskList::GetPtrFromTaskList())
+    std::vector<Task*>                           tasks(records.size(), nullptr);
+    std::unordered_map<std::string_view, Task*>  by_name;
+    by_name.reserve(records.size());
+    for (size_t i=0; i<records.size(); ++i)
+    {
+        const Record& r         = records[i];
+        QDateTime     deadline  = ToDateTime(r.field[kDeadline]),
+                      completed = ToDateTime(r.field[kCompleted]);
+        if ((!r.field[kDeadline].empty() && !deadline.isValid()) || (!r.field[kCompleted].empty() && !completed.isValid()))
+        {
+            ++rejected_count_;
+            continue;
+        }
+        tasks[i] = o_list->AddTaskToList(ToString(r.field[kName]), lazy ? QString() : ToString(r.field[kDescription]), std::move(deadline), std::move(completed));
+        if (lazy && !r.field[kDescription].empty())
+            tasks[i]->SetTaskDescriptionSource(TaskDescriptionSource{i_backing.get(), static_cast<uint32_t>(r.field[kDescription].data() - list_name_.data()),
+                                                                     static_cast<uint32_t>(r.field[kDescription].size())});
+        by_name[r.field[kName]] = tasks[i];
+    }
+
+    // Link prerequisites in the order they were saved, then dependents
+    // Every link is normally saved from both sides; links already made are ignored by the list
+    for (size_t i=0; i<records.size(); ++i)
+    {
+        if (!tasks[i]) continue;
+        ForEachSubfield(records[i].field[kPrereq], [&](std::string_view i_name)
+        {
+            std::unordered_map<std::string_view, Task*>::const_iterator found = by_name.find(i_name);
+            if (found != by_name.end()) o_list->AddTaskPrereq(tasks[i], found->second);
+        });
+    }
+    for (size_t i=0; i<records.size(); ++i)
+    {
+        if (!tasks[i]) continue;
+        ForEachSubfield(records[i].field[kDepend], [&](std::string_view i_name)
+        {
+            std::unordered_map<std::string_view, Task*>::const_iterator found = by_name.find(i_name);
+            if (found != by_name.end()) o_list->AddTaskPrereq(found->second, tasks[i]);
+        });
+    }
+    if (lazy) o_list->SetFileBuffer(std::move(i_backing));
+    return o_list;
+}
+
+const char* TaskFileReader::FindDelimiter(const char* i_begin, const char* i_end)
+{
+    const char* p = i_begin;
+
+#ifdef TELOS_SSE2
+    // Compare 16 bytes against both delimiters at once; the mask has a bit set for each match
+    const __m128i field = _mm_set1_epi8(DIVIDE_FIELD),
+                  task  = _mm_set1_epi8(DIVIDE_TASK);
+    for (; i_end - p >= 16; p += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int     mask  = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, field), _mm_cmpeq_epi8(chunk, task)));
+        if (mask)
+        {
+#if defined(_MSC_VER)
+            unsigned long first;
+            _BitScanForward(&first, static_cast<unsigned long>(mask));
+            return p + first;
+#else
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+#endif
+        }
+    }
+#endif
+
+    // Remaining bytes (or all of them, without SSE2)
+    for (; p != i_end; ++p)
+        if (*p == DIVIDE_FIELD || *p == DIVIDE_TASK)
+            return p;
+    return i_end;
+}
+
+// TaskListManifest
+// Little-endian: magic[8], uint32 version, uint32 entry count, then per entry:
+//   uint32 length + UTF-8 file name, uint32 length + UTF-8 list name, uint32 task count,
+//   int64 file size, int64 file time, int64 journal size, int64 journal time (ms since epoch; 0 if missing)
+
+const char TaskListManifest::MAGIC[8] = {'\x89', 'T', 'L', 'M', '\r', '\n', '\x1a', '\n'};
+
+const TaskListManifest::Entry* TaskListManifest::FindFile(const QString& i_file_name) const
+{
+    for (const Entry& i : entries_)
+        if (i.file_name == i_file_name) return &i;
+    return nullptr;
+}
+
+const TaskListManifest::Entry* TaskListManifest::FindList(const QString& i_list_name) const
+{
+    for (const Entry& i : entries_)
+        if (i.list_name == i_list_name) return &i;
+    return nullptr;
+}
+
+void TaskListManifest::Stat(Entry* io_entry) const
+{
+    QFileInfo file   (QDir(dir_).filePath(io_entry->file_name)),
+              journal(TaskJournal::GetPath(file.filePath()));
+    io_entry->file_size    = file.exists()    ? file.size()                                 : 0;
+    io_entry->file_time    = file.exists()    ? file.lastModified().toMSecsSinceEpoch()     : 0;
+    io_entry->journal_size = journal.exists() ? journal.size()                              : 0;
+    io_entry->journal_time = journal.exists() ? journal.lastModified().toMSecsSinceEpoch()  : 0;
+}
+
+bool TaskListManifest::IsCurrent(const Entry& i_entry) const
+{
+    Entry current = i_entry;
+    Stat(&current);
+    return current.file_size    == i_entry.file_size    && current.file_time    == i_entry.file_time
+        && current.journal_size == i_entry.journal_size && current.journal_time == i_entry.journal_time
+        && current.file_size    != 0;
+}
+
+bool TaskListManifest::Read(void)
+{
+    entries_.clear();
+    QFile file(QDir(dir_).filePath(FILE_NAME));
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    QByteArray  data = file.readAll();
+    const char* in   = data.constData();
+    size_t      size = static_cast<size_t>(data.size()),
+                pos  = 16;
+    if (size < pos || std::memcmp(in, MAGIC, sizeof(MAGIC)) != 0 || qFromLittleEndian<uint32_t>(in + 8) != VERSION)
+        return false;
+
+    // Any entry running past the end of the file means the whole manifest is discarded
+    auto ReadString = [&](QString* o_text) -> bool
+    {
+        if (size - pos < 4) return false;
+        uint32_t length = qFromLittleEndian<uint32_t>(in + pos);
+        if (size - pos - 4 < length) return false;
+        *o_text = TaskFileReader::ToString(std::string_view(in + pos + 4, length));
+        pos += 4 + size_t(length);
+        return true;
+    };
+    uint32_t count = qFromLittleEndian<uint32_t>(in + 12);
+    for (uint32_t i=0; i<count; ++i)
+    {
+        Entry entry;
+        if (!ReadString(&entry.file_name) || !ReadString(&entry.list_name) || size - pos < 36)
+        {
+            entries_.clear();
+            return false;
+        }
+        entry.task_count   = qFromLittleEndian<uint32_t>(in + pos);
+        entry.file_size    = qFromLittleEndian<int64_t> (in + pos + 4);
+        entry.file_time    = qFromLittleEndian<int64_t> (in + pos + 12);
+        entry.journal_size = qFromLittleEndian<int64_t> (in + pos + 20);
+        entry.journal_time = qFromLittleEndian<int64_t> (in + pos + 28);
+        pos += 36;
+        entries_.push_back(std::move(entry));
+    }
+    return true;
+}
+
+QString TaskListManifest::Write(void) const
+{
+    QByteArray data(16, '\0');
+    std::memcpy(data.data(), MAGIC, sizeof(MAGIC));
+    qToLittleEndian<uint32_t>(VERSION,                                 data.data() + 8);
+    qToLittleEndian<uint32_t>(static_cast<uint32_t>(entries_.size()),  data.data() + 12);
+    auto AddString = [&](const QString& i_text)
+    {
+        QByteArray utf8 = i_text.toUtf8();
+        char       length[4];
+        qToLittleEndian<uint32_t>(static_cast<uint32_t>(utf8.size()), length);
+        data.append(length, 4);
+        data.append(utf8);
+    };
+    for (const Entry& i : entries_)
+    {
+        char fields[36];
+        qToLittleEndian<uint32_t>(i.task_count,   fields);
+        qToLittleEndian<int64_t> (i.file_size,    fields + 4);
+        qToLittleEndian<int64_t> (i.file_time,    fields + 12);
+        qToLittleEndian<int64_t> (i.journal_size, fields + 20);
+        qToLittleEndian<int64_t> (i.journal_time, fields + 28);
+        AddString(i.file_name);
+        AddString(i.list_name);
+        data.append(fields, sizeof(fields));
+    }
+
+    QSaveFile file(QDir(dir_).filePath(FILE_NAME));
+    if (!file.open(QIODevice::WriteOnly)) return file.errorString();
+    file.write(data);
+    if (!file.commit()) return file.errorString();
+    return QString();
+}
+
+void TaskListManifest::SetEntry(const QString& i_file_name, const QString& i_list_name, uint32_t i_task_count)
+{
+    Entry entry{i_file_name, i_list_name, i_task_count, 0, 0, 0, 0};
+    Stat(&entry);
+    for (Entry& i : entries_)
+        if (i.file_name == i_file_name)
+        {
+            i = std::move(entry);
+            return;
+        }
+    entries_.push_back(std::move(entry));
+}
+
+void TaskListManifest::RemoveEntry(const QString& i_file_name)
+{
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [&](const Entry& i) { return i.file_name == i_file_name; }), entries_.end());
+}
+
+void TaskListManifest::RetainFiles(const QStringList& i_file_names)
+{
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [&](const Entry& i) { return !i_file_names.contains(i.file_name); }), entries_.end());
+}
@@ -0,0 +1,406 @@
+//    This file is part of Telos
+//    Copyright (c) 2021, Cynical Tech Humor LLC
+
+//    Telos is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    Telos is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with Telos.  If not, see <https://www.gnu.org/licenses/>.
+
+//    Source code is available at:
+//    <https://github.com/CynicalTechHumor/Telos>
+
+#ifndef TASKFILE_H
+#define TASKFILE_H
+
+#include "task.h"
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// TaskFileBuffer()
+// Read-only contents of a task list file: memory-mapped while a list is built from it, otherwise read into memory
+// (compressed files are inflated, and read as if saved uncompressed); descriptions left in it are read as needed
+class TaskFileBuffer
+{
+public:
+
+    // Open()
+    // Map (or read) the file; returns nullptr and sets o_error if it can't be opened
+    static std::shared_ptr<TaskFileBuffer> Open(const QString& i_path, QString* o_error);
+
+    TaskFileBuffer(const TaskFileBuffer&)            = delete;
+    TaskFileBuffer& operator=(const TaskFileBuffer&) = delete;
+    ~TaskFileBuffer();
+
+    // Unmap()
+    // Close a mapped file once loaded, so it can be replaced; GetData() is empty from then on
+    void Unmap (void);
+
+    // Read()
+    // Read a description's bytes; once unmapped, from the file, failing if it has changed size or time since it was opened
+    // Pass the same QFile to read many, so the file is opened once
+    bool Read (const TaskDescriptionSource&, QByteArray* o_bytes, QFile* io_file = nullptr) const;
+
+    // *********
+    // Accessors
+    // *********
+
+    std::string_view GetData      (void) const { return data_;               }
+    bool             IsMapped     (void) const { return map_ != nullptr;     }
+    bool             IsCompressed (void) const { return compressed_;         }
+    QString          GetPath      (void) const { return file_.fileName();    }
+
+private:
+
+    TaskFileBuffer() : map_(nullptr), compressed_(false), size_(0), modified_(0) {}
+
+    QFile            file_;
+    uchar*           map_;
+    QByteArray       copy_;      // Contents, if the file couldn't be mapped (or was inflated)
+    std::string_view data_;
+    bool             compressed_;
+    qint64           size_;      // Size and modification time of the file when opened
+    qint64           modified_;
+};
+
+// TaskListSnapshot()
+// Copy of a list's contents, taken on the UI thread so the list can be written out on a worker thread
+// Descriptions not read yet are read from the list's file (kept alive by the snapshot) as they're written
+struct TaskListSnapshot
+{
+    struct Item
+    {
+        QString               name;
+        QString               description;
+        TaskDescriptionSource description_source;  // Description not read yet, see Task::GetTaskDescriptionSource()
+        QDateTime             deadline;
+        QDateTime             completed;
+    };
+
+    explicit TaskListSnapshot(const TaskList& i_list);
+
+    QString                                    name;
+    std::vector<Item>                          tasks;        // In ID order
+    std::vector<std::pair<uint32_t, uint32_t>> links;        // Task index, prerequisite index; grouped by task, in the order linked
+    std::vector<std::pair<uint32_t, uint32_t>> depends;      // Task index, dependent index; the same links grouped by prerequisite, in the order linked
+    std::shared_ptr<const TaskFileBuffer>      file_buffer;
+};
+
+// TaskFileBinary()
+// Versioned binary .dat format, written by every save since version 1 (layout in taskfile.cpp)
+class TaskFileBinary
+{
+public:
+
+    static constexpr uint16_t VERSION         = 2;
+    static constexpr uint32_t NO_STRING       = UINT32_MAX;
+    static constexpr int64_t  NO_TIME         = INT64_MIN;
+    static constexpr size_t   HEADER_SIZE     = 48;
+    static constexpr size_t   HEADER_SIZE_V1  = 32;
+    static constexpr size_t   TASK_SIZE       = 24;
+    static constexpr size_t   EDGE_SIZE       = 8;
+    static constexpr size_t   STRING_SIZE     = 8;
+    static constexpr uint16_t FLAG_COMPRESSED = 1;
+
+    // IsBinary()
+    // True if the data starts with the binary format's magic bytes (otherwise it may be a legacy file)
+    static bool IsBinary(std::string_view i_data);
+
+    // IsCompressed(), Inflate()
+    // True if the data is a binary file saved with FLAG_COMPRESSED; the file as if saved uncompressed (empty if corrupt)
+    static bool       IsCompressed (std::string_view i_data);
+    static QByteArray Inflate      (std::string_view i_data, QString* o_error);
+
+    // Write()
+    // Serialize a task list (or a snapshot of one), compressed if i_compress
+    // Returns an empty array if descriptions not read yet can't be read from the list's file
+    static QByteArray Write(const TaskListSnapshot& i_snapshot, uint64_t i_journal_id = 0, uint64_t i_journal_offset = 0, bool i_compress = false);
+    static QByteArray Write(const TaskList& i_list, uint64_t i_journal_id = 0, uint64_t i_journal_offset = 0, bool i_compress = false) { return Write(TaskListSnapshot(i_list), i_journal_id, i_journal_offset, i_compress); }
+
+    // WriteFile()
+    // Write a snapshot to a file, replacing it only once the new contents are completely written
+    // Safe to call on a worker thread; returns an empty string on success, otherwise the reason it failed
+    static QString WriteFile(const QString& i_path, const TaskListSnapshot& i_snapshot, uint64_t i_journal_id = 0, uint64_t i_journal_offset = 0, bool i_compress = false);
+
+    // Read()
+    // Build a new task list from binary data; returns nullptr and sets o_error if it's from a newer version or damaged
+    // If i_backing holds the data, descriptions are left in it until first read
+    static std::unique_ptr<TaskList> Read(std::string_view i_data, QString* o_error, std::shared_ptr<const TaskFileBuffer> i_backing = nullptr);
+
+    // GetJournalPosition()
+    // Read only the journal ID/offset from the header (both 0 for version 1 files); false if it isn't a binary list
+    static bool GetJournalPosition(std::string_view i_data, uint64_t* o_id, uint64_t* o_offset);
+
+private:
+
+    static const char MAGIC[8];
+
+    // Header size for the data's version (0 if the data is too short for it)
+    static size_t GetHeaderSize(std::string_view i_data);
+};
+
+// TaskJournal()
+// Append-only log of the changes made to a list since its .dat file was written, kept next to it as "<file>.journal"
+// (layout in taskfile.cpp)
+class TaskJournal
+{
+public:
+
+    static constexpr size_t HEADER_SIZE  = 24;
+    static constexpr qint64 COMPACT_SIZE = 1 << 20;  // Journal size (bytes) past which it is compacted into the .dat file
+
+    // GetPath()
+    // Journal file belonging to a .dat file
+    static QString GetPath(const QString& i_file_path) { return i_file_path + ".journal"; }
+
+    // NewId()
+    // Random non-zero ID for the journal of a newly written .dat file
+    static uint64_t NewId(void);
+
+    // Append()
+    // Append changes to the journal file (created if missing), setting o_end to the offset past them
+    // Returns false and sets o_error if the file can't be written, or belongs to another .dat file than i_id's
+    static bool Append(const QString& i_path, uint64_t i_id, const std::vector<TaskChange>& i_changes, uint64_t* o_end, QString* o_error);
+
+    // Replay()
+    // Apply a journal's records from offset i_from (up to i_to, if not 0) to a list; false if it doesn't have ID i_id
+    // Records that can't be applied are counted in o_rejected; o_torn is set if the data ends partway through one
+    static bool Replay(std::string_view i_data, uint64_t i_id, uint64_t i_from, uint64_t i_to, TaskList* io_list, int* o_rejected, bool* o_torn);
+
+    // Compact()
+    // Rewrite a .dat file to include its journal up to offset i_end, then trim those records; safe on a worker thread
+    // Returns an empty string on success, otherwise the reason it failed
+    static QString Compact(const QString& i_file_path, uint64_t i_id, uint64_t i_end, bool i_compress = false);
+
+    // Trim()
+    // Drop the records before offset i_end from the journal file, if it still has ID i_id
+    // Records appended since are kept; the file is replaced atomically
+    static bool Trim(const QString& i_path, uint64_t i_id, uint64_t i_end, QString* o_error);
+
+private:
+
+    static const char MAGIC[8];
+
+    static QByteArray WriteHeader  (uint64_t i_id, uint64_t i_base);
+    static QByteArray WriteChanges (const std::vector<TaskChange>& i_changes);
+    static bool       ReadHeader   (std::string_view i_data, uint64_t* o_id, uint64_t* o_base);
+    static bool       ApplyChange  (const TaskChange& i_change, TaskList* io_list);
+};
+
+// TaskFileCsv()
+// CSV export/import of a list: the list name, then one line per task with its six fields (layout in taskfile.cpp)
+// Files are written and read CHUNK_SIZE bytes at a time
+class TaskFileCsv
+{
+public:
+
+    static constexpr qsizetype CHUNK_SIZE = 64 * 1024;
+    static constexpr char      SUBFIELD[] = ", ";
+
+    // WriteFile()
+    // Export a snapshot on any thread; i_progress gets the tasks written after each chunk, and returns false to cancel
+    // Returns an empty string on success, otherwise the reason it failed (or that it was cancelled)
+    static QString WriteFile(const QString&                  i_path,
+                             const TaskListSnapshot&         i_snapshot,
+                             char                            i_divide_field,
+                             bool                            i_completed_only,
+                             const std::function<bool(int)>& i_progress = nullptr);
+
+    // ReadFile()
+    // Build a new task list from any RFC 4180 file with those six fields, split by i_divide_field (0 to detect it)
+    // Returns nullptr and sets o_error if the file can't be read; malformed lines are counted in o_rejected
+    static std::unique_ptr<TaskList> ReadFile(const QString& i_path, char i_divide_field, QString* o_error, int* o_rejected);
+
+    // DetectDivideField()
+    // The comma, tab or colon that splits the first line of the data with six fields into them, outside of quotes
+    // Returns a comma if no line does
+    static char DetectDivideField(std::string_view i_data);
+};
+
+// TaskFileReader()
+// Single-pass reader for legacy (pre-binary) Telos .dat files (layout in taskfile.cpp)
+// Fields are returned as views into the buffer, so text is only copied when a task is built from a record
+class TaskFileReader
+{
+public:
+
+    // Delimiter bytes: ASCII control characters, which do not occur in task names/descriptions
+    static constexpr char EMPTY           = 0;
+    static constexpr char DIVIDE_FIELD    = 1;
+    static constexpr char DIVIDE_SUBFIELD = 2;
+    static constexpr char DIVIDE_TASK     = 3;
+
+    enum Field {kName, kDescription, kDeadline, kCompleted, kPrereq, kDepend, kFieldCount};
+
+    // Record()
+    // Fields of one task, as views into the reader's buffer (EMPTY fields are returned as empty views)
+    struct Record
+    {
+        std::string_view field[kFieldCount];
+    };
+
+    // Buffer must outlive the reader and every view it returns
+    explicit TaskFileReader(std::string_view i_data);
+
+    // *********
+    // Accessors
+    // *********
+
+    std::string_view GetListName      (void) const { return list_name_;      }
+    int              GetRejectedCount (void) const { return rejected_count_; }
+    const QString&   GetError         (void) const { return error_;          }
+
+    // ********
+    // Reading
+    // ********
+
+    // ReadRecord()
+    // Read the next well-formed record, counting malformed ones as rejected; false at the end of the buffer
+    bool ReadRecord(Record* o_record);
+
+    // ReadTaskList()
+    // Read every remaining record into a new task list; nullptr (see GetError()) if the file has no list name
+    // If i_backing holds the reader's buffer, descriptions are left in it until first read
+    std::unique_ptr<TaskList> ReadTaskList(std::shared_ptr<const TaskFileBuffer> i_backing = nullptr);
+
+    // ******
+    // Static
+    // ******
+
+    // FindDelimiter()
+    // First DIVIDE_FIELD or DIVIDE_TASK byte in [i_begin, i_end), or i_end if there is none
+    // Scans 16 bytes at a time where SSE2 is available
+    static const char* FindDelimiter(const char* i_begin, const char* i_end);
+
+    // ForEachSubfield()
+    // Call i_func with each name in a prerequisite/dependent field
+    template <typename Func>
+    static void ForEachSubfield(std::string_view i_field, Func i_func)
+    {
+        while (!i_field.empty())
+        {
+            size_t end = i_field.find(DIVIDE_SUBFIELD);
+            i_func(i_field.substr(0, end));
+            if (end == std::string_view::npos) break;
+            i_field.remove_prefix(end + 1);
+        }
+    }
+
+    // ToString(), ToDateTime()
+    // Convert a field view to a string or date/time; an empty view gives an empty string/invalid date
+    static QString   ToString   (std::string_view i_view) { return QString::fromUtf8(i_view.data(), static_cast<qsizetype>(i_view.size())); }
+    static QDateTime ToDateTime (std::string_view i_view) { return i_view.empty() ? QDateTime() : QDateTime::fromString(ToString(i_view)); }
+
+private:
+
+    const char*      pos_;
+    const char*      end_;
+    std::string_view list_name_;
+    int              rejected_count_;
+    QString          error_;
+
+    // Strip the EMPTY marker from a field, leaving an empty view
+    static std::string_view StripEmpty (std::string_view i_field) { return (i_field.size() == 1 && i_field[0] == EMPTY) ? std::string_view() : i_field; }
+};
+
+// TaskFileLoad()
+// Reads one task list file and its journal (or a CSV export); touches nothing else, so it can run on a worker thread
+struct TaskFileLoad
+{
+    QString                   path;
+    std::unique_ptr<TaskList> list;      // nullptr if the file couldn't be read (see error)
+    QString                   error;
+    QStringList               warnings;  // Problems that didn't stop the list from loading, e.g. skipped records
+
+    // Read()
+    // Read the file at path (descriptions are left in it until first read); with i_journal, also apply its journal
+    void Read(bool i_journal);
+
+    // ReadCsv()
+    // Read the file at path as CSV (see TaskFileCsv::ReadFile()), detecting the field delineator
+    void ReadCsv(void);
+};
+
+// TaskListManifest()
+// Index of the task lists in a directory, so startup can show every list without reading it (layout in taskfile.cpp)
+// An entry is only trusted while its file and journal have the size and time recorded
+class TaskListManifest
+{
+public:
+
+    static constexpr uint32_t VERSION     = 1;
+    static constexpr char     FILE_NAME[] = "Telos.manifest";
+
+    struct Entry
+    {
+        QString  file_name;
+        QString  list_name;
+        uint32_t task_count;
+        qint64   file_size;
+        qint64   file_time;
+        qint64   journal_size;
+        qint64   journal_time;
+    };
+
+    explicit TaskListManifest(const QString& i_dir = QString()) : dir_(i_dir) {}
+
+    // *********
+    // Accessors
+    // *********
+
+    const std::vector<Entry>& GetEntries (void) const { return entries_; }
+
+    // FindFile(), FindList()
+    // Entry for a file/list name, or nullptr if there is none
+    const Entry* FindFile (const QString& i_file_name) const;
+    const Entry* FindList (const QString& i_list_name) const;
+
+    // IsCurrent()
+    // True if the entry's file and journal are unchanged since it was recorded
+    bool IsCurrent (const Entry& i_entry) const;
+
+    // ********
+    // Mutators
+    // ********
+
+    // Read(), Write()
+    // Load/save the manifest file; Read() leaves it empty (returning false) if the file is missing or unreadable,
+    // Write() returns an empty string on success, otherwise the reason it failed
+    bool    Read  (void);
+    QString Write (void) const;
+
+    // SetEntry(), RemoveEntry(), RetainFiles()
+    // Record a list as saved in a file now; forget a file; forget every file not in the input list
+    void SetEntry    (const QString& i_file_name, const QString& i_list_name, uint32_t i_task_count);
+    void RemoveEntry (const QString& i_file_name);
+    void RetainFiles (const QStringList& i_file_names);
+
+private:
+
+    static const char MAGIC[8];
+
+    QString            dir_;
+    std::vector<Entry> entries_;
+
+    // Fill in the file/journal sizes and times of an entry from disk
+    void Stat (Entry* io_entry) const;
+};
+
+#endif // TASKFILE_H
@@ -0,0 +1,329 @@
+//    This file is part of Telos
+//    Copyright (c) 2021, Cynical Tech Humor LLC
+
+//    Telos is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    Telos is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with Telos.  If not, see <https://www.gnu.org/licenses/>.
+
+//    Source code is available at:
+//    <https://github.com/CynicalTechHumor/Telos>
+
+#include "taskgraph.h"
+
+#include <algorithm>
+
+// TaskGraph
+
+bool TaskGraph::HasEdge(Id i_task, Id i_prereq) const
+{
+    return forward_.Contains(i_task, i_prereq);
+}
+
+bool TaskGraph::AddEdge(Id i_task, Id i_prereq)
+{
+    if (i_task == INVALID_ID || i_prereq == INVALID_ID || i_task == i_prereq) return false;
+    if (!forward_.Insert(i_task, i_prereq)) return false;
+    reverse_.Insert(i_prereq, i_task);
+    return true;
+}
+
+bool TaskGraph::RemoveEdge(Id i_task, Id i_prereq)
+{
+    if (!forward_.Remove(i_task, i_prereq)) return false;
+    reverse_.Remove(i_prereq, i_task);
+    return true;
+}
+
+void TaskGraph::RemoveAllEdges(Id i_task)
+{
+    // Unlink the task from the opposite row of each neighbour, then drop its own rows
+    for (Id i : forward_.GetRow(i_task))
+        reverse_.Remove(i, i_task);
+    for (Id i : reverse_.GetRow(i_task))
+        forward_.Remove(i, i_task);
+    forward_.ClearRow(i_task);
+    reverse_.ClearRow(i_task);
+}
+
+// TaskGraph::AdjacencyStore
+
+TaskGraph::IdRange TaskGraph::AdjacencyStore::GetRow(Id i_row) const
+{
+    if (i_row >= rows_.size() || !rows_[i_row].count) return IdRange();
+    const Id* row_begin = edges_.data() + rows_[i_row].offset;
+    return IdRange(row_begin, row_begin + rows_[i_row].count);
+}
+
+bool TaskGraph::AdjacencyStore::Contains(Id i_row, Id i_id) const
+{
+    IdRange row = GetRow(i_row);
+    return std::find(row.begin(), row.end(), i_id) != row.end();
+}
+
+bool TaskGraph::AdjacencyStore::Insert(Id i_row, Id i_id)
+{
+    if (Contains(i_row, i_id)) return false;
+    if (i_row >= rows_.size()) rows_.resize(i_row + 1);
+
+    Row* row = &rows_[i_row];
+    if (row->count == row->capacity)
+    {
+        Grow(*row);
+        if (unused_ > edges_.size() / 2)
+        {
+            Compact();
+            row = &rows_[i_row];
+            if (row->count == row->capacity) Grow(*row);
+        }
+    }
+    edges_[row->offset + row->count++] = i_id;
+    ++count_;
+    return true;
+}
+
+bool TaskGraph::AdjacencyStore::Remove(Id i_row, Id i_id)
+{
+    if (i_row >= rows_.size()) return false;
+
+    // Shift the rest of the row down so prerequisites keep the order they were added in
+    Row&                        row       = rows_[i_row];
+    std::vector<Id>::iterator   row_begin = edges_.begin() + row.offset,
+                                row_end   = row_begin + row.count,
+                                found     = std::find(row_begin, row_end, i_id);
+    if (found == row_end) return false;
+    std::copy(found + 1, row_end, found);
+    --row.count;
+    --count_;
+    return true;
+}
+
+void TaskGraph::AdjacencyStore::ClearRow(Id i_row)
+{
+    if (i_row >= rows_.size()) return;
+    count_  -= rows_[i_row].count;
+    unused_ += rows_[i_row].capacity;
+    rows_[i_row] = Row();
+}
+
+void TaskGraph::AdjacencyStore::Grow(Row& io_row)
+{
+    uint32_t new_capacity = io_row.capacity ? io_row.capacity * 2 : 2;
+
+    // Last row in the array: extend in place
+    if (io_row.capacity && io_row.offset + io_row.capacity == edges_.size())
+    {
+        edges_.resize(io_row.offset + new_capacity);
+        io_row.capacity = new_capacity;
+        return;
+    }
+
+    // Otherwise move the row to the end of the array, abandoning its old slots
+    uint32_t new_offset = static_cast<uint32_t>(edges_.size());
+    edges_.resize(new_offset + new_capacity);
+    std::copy(edges_.begin() + io_row.offset, edges_.begin() + io_row.offset + io_row.count, edges_.begin() + new_offset);
+    unused_         += io_row.capacity;
+    io_row.offset    = new_offset;
+    io_row.capacity  = new_capacity;
+}
+
+void TaskGraph::AdjacencyStore::Compact(void)
+{
+    // Repack every row back to back, keeping each row's capacity
+    std::vector<Id> packed;
+    packed.reserve(edges_.size() - unused_);
+    for (Row& i : rows_)
+    {
+        uint32_t new_offset = static_cast<uint32_t>(packed.size());
+        packed.insert(packed.end(), edges_.begin() + i.offset, edges_.begin() + i.offset + i.capacity);
+        i.offset = i.capacity ? new_offset : 0;
+    }
+    edges_.swap(packed);
+    unused_ = 0;
+}
+
+// TaskReachability
+
+void TaskReachability::MergeChainedPrereq(Id i_task, std::vector<uint64_t>* io_mask) const
+{
+    const uint64_t* row = bits_.data() + size_t(i_task) * words_;
+    for (size_t i=0; i<words_; ++i)
+        (*io_mask)[i] |= row[i];
+    (*io_mask)[i_task >> 6] |= uint64_t(1) << (i_task & 63);
+}
+
+void TaskReachability::Rebuild(const TaskGraph& i_graph, Id i_size)
+{
+    valid_ = false;
+    if (i_size > MAX_CAPACITY)
+    {
+        bits_.clear();
+        bits_.shrink_to_fit();
+        capacity_ = 0;
+        words_    = 0;
+        return;
+    }
+
+    // Leave room for new tasks, so adding a few doesn't force a rebuild
+    capacity_ = std::min<Id>(((i_size + i_size / 8) / 64 + 1) * 64, MAX_CAPACITY);
+    words_    = capacity_ / 64;
+    bits_.assign(size_t(capacity_) * words_, 0);
+
+    // Order tasks so each comes after all of its prerequisites (iterative post-order DFS)
+    // visited: 0 = not yet, 1 = on the DFS stack, 2 = finished; reaching a task on the stack means a cycle
+    std::vector<Id>                    order;
+    std::vector<uint8_t>               visited(i_size, 0);
+    std::vector<std::pair<Id, size_t>> stack;
+    bool                               cyclic = false;
+    order.reserve(i_size);
+    for (Id root=0; root<i_size; ++root)
+    {
+        if (visited[root]) continue;
+        visited[root] = 1;
+        stack.emplace_back(root, 0);
+        while (!stack.empty())
+        {
+            Id                 current = stack.back().first;
+            TaskGraph::IdRange prereqs = i_graph.GetPrereq(current);
+            if (stack.back().second < prereqs.size())
+            {
+                Id next = prereqs[stack.back().second++];
+                if (next >= i_size) continue;
+                if (visited[next] == 1) cyclic = true;
+                if (visited[next]) continue;
+                visited[next] = 1;
+                stack.emplace_back(next, 0);
+            }
+            else
+            {
+                visited[current] = 2;
+                order.push_back(current);
+                stack.pop_back();
+            }
+        }
+    }
+
+    // Each row is the union of its prerequisites' rows plus the prerequisites themselves
+    // One pass is exact for an acyclic graph; repeat until stable in case a loaded file contains a cycle
+    bool changed;
+    do
+    {
+        changed = false;
+        for (Id i : order)
+        {
+            uint64_t* row = Row(i);
+            for (Id j : i_graph.GetPrereq(i))
+            {
+                if (j >= i_size) continue;
+                const uint64_t* prereq_row = Row(j);
+                for (size_t k=0; k<words_; ++k)
+                {
+                    uint64_t merged = row[k] | prereq_row[k];
+                    if (k == (j >> 6)) merged |= uint64_t(1) << (j & 63);
+                    if (merged != row[k])
+                    {
+                        row[k]  = merged;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    } while (cyclic && changed);
+    valid_ = true;
+}
+
+void TaskReachability::AddEdge(const TaskGraph& i_graph, Id i_task, Id i_prereq)
+{
+    if (!valid_) return;
+    if (i_task >= capacity_ || i_prereq >= capacity_)
+    {
+        valid_ = false;
+        return;
+    }
+
+    // Bits gained by i_task: i_prereq and its chain
+    std::vector<uint64_t> gained(words_, 0);
+    MergeChainedPrereq(i_prereq, &gained);
+
+    // Push them to i_task and its dependents
+    // A task that already has them all can be skipped along with its dependents, whose rows contain its row
+    std::vector<Id> stack(1, i_task);
+    while (!stack.empty())
+    {
+        Id current = stack.back();
+        stack.pop_back();
+        uint64_t* row     = Row(current);
+        bool      changed = false;
+        for (size_t k=0; k<words_; ++k)
+        {
+            if ((row[k] | gained[k]) == row[k]) continue;
+            row[k] |= gained[k];
+            changed = true;
+        }
+        if (!changed) continue;
+        for (Id i : i_graph.GetDepend(current))
+            stack.push_back(i);
+    }
+}
+
+void TaskReachability::RemoveEdges(const TaskGraph& i_graph, const std::vector<Id>& i_tasks)
+{
+    if (!valid_) return;
+
+    // Order the affected tasks so each comes after its affected prerequisites: reverse post-order of a DFS over dependents
+    // visited: 0 = not yet, 1 = on the DFS stack, 2 = finished; reaching a task on the stack means a cycle
+    std::vector<Id>                    order;
+    std::vector<uint8_t>               visited(capacity_, 0);
+    std::vector<std::pair<Id, size_t>> stack;
+    for (Id root : i_tasks)
+    {
+        if (visited[root]) continue;
+        visited[root] = 1;
+        stack.emplace_back(root, 0);
+        while (!stack.empty())
+        {
+            Id                 current = stack.back().first;
+            TaskGraph::IdRange depends = i_graph.GetDepend(current);
+            if (stack.back().second < depends.size())
+            {
+                Id next = depends[stack.back().second++];
+                if (visited[next] == 1)
+                {
+                    valid_ = false;
+                    return;
+                }
+                if (visited[next]) continue;
+                visited[next] = 1;
+                stack.emplace_back(next, 0);
+            }
+            else
+            {
+                visited[current] = 2;
+                order.push_back(current);
+                stack.pop_back();
+            }
+        }
+    }
+
+    // Rows of unaffected prerequisites are still exact, so one pass rebuilds the affected rows from them
+    for (size_t i=order.size(); i-- > 0;)
+    {
+        uint64_t* row = Row(order[i]);
+        std::fill(row, row + words_, 0);
+        for (Id j : i_graph.GetPrereq(order[i]))
+        {
+            const uint64_t* prereq_row = Row(j);
+            for (size_t k=0; k<words_; ++k)
+                row[k] |= prereq_row[k];
+            row[j >> 6] |= uint64_t(1) << (j & 63);
+        }
+    }
+}
@@ -0,0 +1,192 @@
+//    This file is part of Telos
+//    Copyright (c) 2021, Cynical Tech Humor LLC
+
+//    Telos is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    Telos is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with Telos.  If not, see <https://www.gnu.org/licenses/>.
+
+//    Source code is available at:
+//    <https://github.com/CynicalTechHumor/Telos>
+
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// TaskGraph()
+// Prerequisite graph for a task list, keyed by dense task IDs, with each direction stored CSR-style
+class TaskGraph
+{
+public:
+
+    typedef uint32_t Id;
+
+    static constexpr Id INVALID_ID = UINT32_MAX;
+
+    // IdRange()
+    // Read-only view of one adjacency row; invalidated by the next graph mutation
+    class IdRange
+    {
+    public:
+        IdRange()                                   : begin_(nullptr), end_(nullptr) {}
+        IdRange(const Id* i_begin, const Id* i_end) : begin_(i_begin), end_(i_end)   {}
+
+        const Id* begin      (void)     const { return begin_;         }
+        const Id* end        (void)     const { return end_;           }
+        size_t    size       (void)     const { return end_ - begin_;  }
+        bool      empty      (void)     const { return begin_ == end_; }
+        Id        operator[] (size_t i) const { return begin_[i];      }
+
+    private:
+        const Id* begin_;
+        const Id* end_;
+    };
+
+    // *********
+    // Accessors
+    // *********
+
+    IdRange GetPrereq    (Id i_task) const { return forward_.GetRow(i_task); }
+    IdRange GetDepend    (Id i_task) const { return reverse_.GetRow(i_task); }
+    size_t  GetEdgeCount (void)      const { return forward_.GetCount();     }
+    bool    HasEdge      (Id i_task, Id i_prereq) const;
+
+    // ********
+    // Mutators
+    // ********
+
+    // AddEdge(), RemoveEdge()
+    // Link/unlink a prerequisite to a task, updating both directions
+    // Return false if nothing changed (edge already present/absent, or invalid input)
+    bool AddEdge    (Id i_task, Id i_prereq);
+    bool RemoveEdge (Id i_task, Id i_prereq);
+
+    // RemoveAllEdges()
+    // Disconnect a task from all of its prerequisites and dependents
+    void RemoveAllEdges (Id i_task);
+
+    // Reserve(), Clear()
+    // Make room for (at least) the input number of task IDs; remove every edge and row
+    void Reserve (Id i_size) { forward_.Reserve(i_size); reverse_.Reserve(i_size); }
+    void Clear   (void)      { forward_.Clear();         reverse_.Clear();         }
+
+protected:
+
+    // AdjacencyStore()
+    // One direction of the graph: rows with spare capacity in a single edge array, moved to the end when full
+    // The array is compacted once more than half of it is abandoned space
+    class AdjacencyStore
+    {
+    public:
+        AdjacencyStore() : unused_(0), count_(0) {}
+
+        IdRange GetRow   (Id i_row)          const;
+        size_t  GetCount (void)              const { return count_; }
+        bool    Contains (Id i_row, Id i_id) const;
+
+        bool Insert   (Id i_row, Id i_id);
+        bool Remove   (Id i_row, Id i_id);
+        void ClearRow (Id i_row);
+        void Reserve  (Id i_size)  { if (rows_.size() < i_size) rows_.resize(i_size); }
+        void Clear    (void)       { rows_.clear(); edges_.clear(); unused_ = 0; count_ = 0; }
+
+    private:
+        struct Row
+        {
+            uint32_t offset   = 0;
+            uint32_t count    = 0;
+            uint32_t capacity = 0;
+        };
+
+        std::vector<Row> rows_;
+        std::vector<Id>  edges_;
+        size_t           unused_;  // Slots abandoned by relocated/cleared rows
+        size_t           count_;   // Edges currently stored
+
+        void Grow    (Row&);
+        void Compact (void);
+    };
+
+    // Data
+    AdjacencyStore forward_;  // Task -> prerequisites
+    AdjacencyStore reverse_;  // Task -> dependents
+};
+
+// TaskReachability()
+// Bitset transitive closure of a TaskGraph: each task's row has a bit set for every task in its prerequisite chain
+// Links update the rows in place; graphs of more than MAX_CAPACITY tasks aren't indexed
+class TaskReachability
+{
+public:
+
+    typedef TaskGraph::Id Id;
+
+    static constexpr Id MAX_CAPACITY = 16384;  // 32 MiB of rows
+
+    TaskReachability() : capacity_(0), words_(0), valid_(false) {}
+
+    // *********
+    // Accessors
+    // *********
+
+    bool IsValid     (void) const { return valid_;    }
+    Id   GetCapacity (void) const { return capacity_; }
+
+    // IsChainedPrereq()
+    // True if i_prereq is anywhere in the prerequisite chain of i_task
+    // Index must be valid, and both IDs within the size it was built for
+    bool IsChainedPrereq(Id i_task, Id i_prereq) const
+    {
+        return (bits_[size_t(i_task) * words_ + (i_prereq >> 6)] >> (i_prereq & 63)) & 1;
+    }
+
+    // MergeChainedPrereq()
+    // OR a task and its prerequisite chain into a bit mask of GetWordCount() words
+    void   MergeChainedPrereq (Id i_task, std::vector<uint64_t>* io_mask) const;
+    size_t GetWordCount       (void) const { return words_; }
+    static bool TestBit       (const std::vector<uint64_t>& i_mask, Id i_id) { return (i_mask[i_id >> 6] >> (i_id & 63)) & 1; }
+
+    // ********
+    // Mutators
+    // ********
+
+    // Rebuild()
+    // Recompute the closure from scratch for IDs below i_size; left invalid if i_size is over MAX_CAPACITY
+    void Rebuild (const TaskGraph&, Id i_size);
+
+    // AddEdge()
+    // Update the closure after i_prereq was linked to i_task in the graph
+    // Invalidates the index instead if either ID is beyond the capacity it was built with
+    void AddEdge (const TaskGraph&, Id i_task, Id i_prereq);
+
+    // RemoveEdges()
+    // Update the closure after prerequisites were unlinked from i_tasks: only their rows and their dependents' are recomputed
+    // Invalidates the index instead if those rows form a cycle
+    void RemoveEdges (const TaskGraph&, const std::vector<Id>& i_tasks);
+
+    // Invalidate()
+    // Mark the index as stale, e.g. after every task was removed
+    void Invalidate (void) { valid_ = false; }
+
+private:
+
+    std::vector<uint64_t> bits_;      // capacity_ rows of words_ 64-bit words each
+    Id                    capacity_;  // Number of rows (and bits per row)
+    size_t                words_;
+    bool                  valid_;
+
+    uint64_t* Row (Id i_id) { return bits_.data() + size_t(i_id) * words_; }
+};
+
+#endif // TASKGRAPH_H
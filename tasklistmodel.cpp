@@ -0,0 +1,397 @@
+//    This file is part of Telos
+//    Copyright (c) 2021, Cynical Tech Humor LLC
+
+//    Telos is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    Telos is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with Telos.  If not, see <https://www.gnu.org/licenses/>.
+
+//    Source code is available at:
+//    <https://github.com/CynicalTechHumor/Telos>
+
+#include "tasklistmodel.h"
+
+#include <QFont>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+TaskListModel::TaskListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+    list_            = nullptr;
+    filter_          = TaskFilter::kCurrent;
+    sort_            = TaskSort::kName;
+    request_filter_  = filter_;
+    request_sort_    = sort_;
+    sort_generation_ = 0;
+    sorting_         = false;
+    sort_outdated_   = false;
+    std::fill(orders_valid_, orders_valid_ + SORT_COUNT, false);
+    connect(&sort_watcher_, &QFutureWatcher<SortResult>::finished, this, &TaskListModel::FinishSort);
+}
+
+TaskListModel::~TaskListModel()
+{
+    // A sort still running only holds its snapshot, so it's left to finish on its own
+    CancelSort();
+    if (list_) list_->SetEventHandler(nullptr);
+}
+
+void TaskListModel::SetTasks(TaskList* i_list, TaskFilter i_filter, TaskSort i_sort)
+{
+    if (i_list == list_ && i_filter == request_filter_ && i_sort == request_sort_) return;
+
+    // Follow the changes of the new list only (a list being destroyed reports kClose, so list_ is never left dangling)
+    // A new list needs new keys; the same list with another filter or sort keeps its keys and cached orders
+    bool flag_new_list = list_ != i_list;
+    if (flag_new_list)
+    {
+        if (list_) list_->SetEventHandler(nullptr);
+        list_ = i_list;
+        if (list_) list_->SetEventHandler([this](const TaskEvent& i_event) { OnTaskEvent(i_event); });
+        UpdateKeys();
+    }
+    request_filter_ = i_filter;
+    request_sort_   = i_sort;
+
+    // Whatever is still sorting is outdated now; going back to the rows shown needs nothing more
+    CancelSort();
+    if (!flag_new_list && request_filter_ == filter_ && request_sort_ == sort_) return;
+
+    // Rebuild the rows now if that's quick: a small list, or one whose order is cached, only needs a pass to filter it
+    // Otherwise sort in the background; a new list shows no rows until then, as the old rows are of another list
+    if (!list_ || list_->GetTaskListSize() < ASYNC_SORT_TASKS || orders_valid_[static_cast<int>(request_sort_)])
+        Rebuild();
+    else
+    {
+        if (flag_new_list) Clear();
+        StartSort();
+    }
+}
+
+Task* TaskListModel::GetTask(int i_row) const
+{
+    return list_ && i_row >= 0 && i_row < static_cast<int>(rows_.size()) ? list_->GetPtrFromId(rows_[i_row]) : nullptr;
+}
+
+int TaskListModel::GetRow(const Task* i_ptr) const
+{
+    // A task removed since may share its ID with another, so check the row still shows this one
+    if (!i_ptr || i_ptr->GetTaskId() >= row_of_id_.size()) return -1;
+    int row = row_of_id_[i_ptr->GetTaskId()];
+    return row >= 0 && GetTask(row) == i_ptr ? row : -1;
+}
+
+void TaskListModel::UpdateDirty(void)
+{
+    if (!rows_.empty())
+        emit dataChanged(index(0), index(static_cast<int>(rows_.size()) - 1), {Qt::FontRole});
+}
+
+int TaskListModel::rowCount(const QModelIndex& i_parent) const
+{
+    return i_parent.isValid() ? 0 : static_cast<int>(rows_.size());
+}
+
+QVariant TaskListModel::data(const QModelIndex& i_index, int i_role) const
+{
+    const Task* task = GetTask(i_index);
+    if (!task) return QVariant();
+    if (i_role == Qt::DisplayRole)
+        return task->GetTaskName();
+    if (i_role == Qt::FontRole && list_->IsTaskDirty(task))
+    {
+        QFont font;
+        font.setItalic(true);
+        return font;
+    }
+    return QVariant();
+}
+
+bool TaskListModel::IsShown(Task::Id i_id) const
+{
+    TaskState state = list_->GetTaskState(list_->GetPtrFromId(i_id));
+    switch (filter_)
+    {
+    case TaskFilter::kAll:       return true;                            // Don't filter it, y'know
+    case TaskFilter::kCompleted: return state == TaskState::kCompleted;
+    case TaskFilter::kCurrent:   return state == TaskState::kCurrent;    // Incomplete, all prerequisites complete
+    case TaskFilter::kPending:   return state == TaskState::kPending;    // Incomplete, some prerequisite incomplete
+    }
+    return false;
+}
+
+template<typename NameOf>
+bool TaskListModel::IsBefore(TaskSort i_sort, const std::vector<SortKey>& i_keys, const NameOf& i_name_of, Task::Id i_left, Task::Id i_right)
+{
+    // Sorting by name puts tasks of the same name in deadline order, and vice versa
+    const SortKey& left  = i_keys[i_left];
+    const SortKey& right = i_keys[i_right];
+    if (i_sort == TaskSort::kDeadline && left.deadline != right.deadline)
+        return left.deadline < right.deadline;
+    if (left.name != right.name)
+        return left.name < right.name;
+    const QString& left_name  = i_name_of(i_left);
+    const QString& right_name = i_name_of(i_right);
+    if (left_name != right_name)
+        return left_name < right_name;
+    if (left.deadline != right.deadline)
+        return left.deadline < right.deadline;
+    return i_left < i_right;
+}
+
+bool TaskListModel::IsBefore(Task::Id i_left, Task::Id i_right) const
+{
+    return IsBefore(sort_, keys_, [this](Task::Id i_id) -> const QString& { return list_->GetPtrFromId(i_id)->GetTaskName(); },
+                    i_left, i_right);
+}
+
+void TaskListModel::UpdateKey(Task::Id i_id)
+{
+    if (i_id >= keys_.size()) keys_.resize(i_id + 1);
+    const Task*      task     = list_->GetPtrFromId(i_id);
+    const QString&   name     = task->GetTaskName();
+    const QDateTime& deadline = task->GetTaskDeadline();
+    SortKey&         key      = keys_[i_id];
+    key.deadline = deadline.isValid() ? deadline.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+    key.name     = 0;
+    for (int i=0; i<4; ++i)
+        key.name = key.name << 16 | (i < name.size() ? name[i].unicode() : 0);
+}
+
+void TaskListModel::UpdateKeys(void)
+{
+    keys_.assign(list_ ? list_->GetTaskIdBound() : 0, SortKey{});
+    if (list_)
+        for (Task* i : list_->GetTaskRange())
+            UpdateKey(i->GetTaskId());
+    std::fill(orders_valid_, orders_valid_ + SORT_COUNT, false);
+}
+
+void TaskListModel::Rebuild(void)
+{
+    // Sort every task of the list in a single pass over the keys, unless the order is cached,
+    // then take the tasks that pass the filter in that order
+    beginResetModel();
+    filter_ = request_filter_;
+    sort_   = request_sort_;
+    rows_.clear();
+    if (list_)
+    {
+        Task::IdVector& order = orders_[static_cast<int>(sort_)];
+        if (!orders_valid_[static_cast<int>(sort_)])
+        {
+            order.clear();
+            order.reserve(list_->GetTaskListSize());
+            for (Task* i : list_->GetTaskRange())
+                order.push_back(i->GetTaskId());
+            std::sort(order.begin(), order.end(), [this](Task::Id i_left, Task::Id i_right) { return IsBefore(i_left, i_right); });
+            orders_valid_[static_cast<int>(sort_)] = true;
+        }
+        if (filter_ == TaskFilter::kAll)
+            rows_ = order;
+        else
+            std::copy_if(order.begin(), order.end(), std::back_inserter(rows_), [this](Task::Id i_id) { return IsShown(i_id); });
+    }
+    row_of_id_.assign(list_ ? list_->GetTaskIdBound() : 0, -1);
+    UpdateRowsOf(0, static_cast<int>(rows_.size()));
+    endResetModel();
+}
+
+void TaskListModel::Clear(void)
+{
+    beginResetModel();
+    filter_ = request_filter_;
+    sort_   = request_sort_;
+    rows_.clear();
+    row_of_id_.assign(list_ ? list_->GetTaskIdBound() : 0, -1);
+    endResetModel();
+}
+
+void TaskListModel::OnTaskEvent(const TaskEvent& i_event)
+{
+    // Every row is rebuilt after a reset, so there's no need to finish sorting the list as it was
+    if (i_event.type == TaskEvent::kClose) list_ = nullptr;
+    if (i_event.type == TaskEvent::kClose || i_event.type == TaskEvent::kReset)
+    {
+        CancelSort();
+        UpdateKeys();
+        Rebuild();
+        return;
+    }
+
+    // Adding, removing or reordering a task outdates the cached orders and any sort in progress (redone once it finishes)
+    // Other changes, such as its state, don't affect the order
+    if (i_event.type != TaskEvent::kChange)
+    {
+        std::fill(orders_valid_, orders_valid_ + SORT_COUNT, false);
+        sort_outdated_ = sorting_;
+    }
+    if (i_event.type == TaskEvent::kAdd || i_event.type == TaskEvent::kReorder)
+        UpdateKey(i_event.id);
+
+    // Compare where the task is shown (IDs new to the model aren't) with whether it should be
+    if (i_event.id >= row_of_id_.size()) row_of_id_.resize(i_event.id + 1, -1);
+    int   row   = row_of_id_[i_event.id],
+          count = static_cast<int>(rows_.size());
+    Task* task  = i_event.type == TaskEvent::kRemove ? nullptr : list_->GetPtrFromId(i_event.id);
+    bool  shown = task && IsShown(i_event.id);
+    if (row < 0 && !shown) return;
+
+    // Newly shown: insert it in order
+    if (row < 0)
+    {
+        int position = FindPosition(i_event.id, 0, count);
+        beginInsertRows(QModelIndex(), position, position);
+        rows_.insert(rows_.begin() + position, i_event.id);
+        UpdateRowsOf(position, count + 1);
+        endInsertRows();
+        return;
+    }
+
+    // Removed, or filtered out: remove its row
+    if (!shown)
+    {
+        beginRemoveRows(QModelIndex(), row, row);
+        rows_.erase(rows_.begin() + row);
+        row_of_id_[i_event.id] = -1;
+        UpdateRowsOf(row, count - 1);
+        endRemoveRows();
+        return;
+    }
+
+    // Still shown: if it's out of order now (e.g. renamed), move it among the other rows on the side it now sorts to
+    bool after_previous = row == 0         || IsBefore(rows_[row - 1], i_event.id);
+    bool before_next    = row == count - 1 || IsBefore(i_event.id, rows_[row + 1]);
+    if (!after_previous)
+    {
+        int position = FindPosition(i_event.id, 0, row);
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), position);
+        std::rotate(rows_.begin() + position, rows_.begin() + row, rows_.begin() + row + 1);
+        UpdateRowsOf(position, row + 1);
+        endMoveRows();
+        row = position;
+    }
+    else if (!before_next)
+    {
+        int position = FindPosition(i_event.id, row + 1, count) - 1;  // Once its row is taken out
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), position + 1);
+        std::rotate(rows_.begin() + row, rows_.begin() + row + 1, rows_.begin() + position + 1);
+        UpdateRowsOf(row, position + 1);
+        endMoveRows();
+        row = position;
+    }
+    emit dataChanged(index(row), index(row));
+}
+
+int TaskListModel::FindPosition(Task::Id i_id, int i_first, int i_last) const
+{
+    return static_cast<int>(std::partition_point(rows_.begin() + i_first, rows_.begin() + i_last, [this, i_id](Task::Id i_row_id)
+    {
+        return IsBefore(i_row_id, i_id);
+    }) - rows_.begin());
+}
+
+void TaskListModel::UpdateRowsOf(int i_first, int i_last)
+{
+    for (int i=i_first; i<i_last; ++i)
+        row_of_id_[rows_[i]] = i;
+}
+
+void TaskListModel::StartSort(void)
+{
+    // Copy what the worker needs, so the list can be edited meanwhile (names are shared, so only referenced)
+    auto input = std::make_shared<SortInput>();
+    input->generation = ++sort_generation_;
+    input->sort       = request_sort_;
+    input->keys       = keys_;
+    input->names.resize(list_->GetTaskIdBound());
+    input->ids.reserve(list_->GetTaskListSize());
+    for (Task* i : list_->GetTaskRange())
+    {
+        input->ids.push_back(i->GetTaskId());
+        input->names[i->GetTaskId()] = i->GetTaskName();
+    }
+
+    // Replace any sort running: it's cancelled, and its result would be dropped anyway as it's of an earlier generation
+    sort_watcher_.cancel();
+    sort_watcher_.setFuture(QtConcurrent::run([input = std::shared_ptr<const SortInput>(std::move(input))](QPromise<SortResult>& io_promise)
+    {
+        SortTasks(*input, io_promise);
+    }));
+    sorting_       = true;
+    sort_outdated_ = false;
+}
+
+void TaskListModel::CancelSort(void)
+{
+    if (!sorting_) return;
+    ++sort_generation_;
+    sort_watcher_.cancel();
+    sorting_       = false;
+    sort_outdated_ = false;
+}
+
+void TaskListModel::FinishSort(void)
+{
+    // Only the result of the latest sort is shown
+    QFuture<SortResult> future = sort_watcher_.future();
+    if (!sorting_ || future.isCanceled() || future.resultCount() == 0) return;
+    SortResult result = future.result();
+    if (result.generation != sort_generation_) return;
+
+    // Sort again if tasks were added, removed or reordered since the snapshot; the snapshot is taken once per sort,
+    // however many changes were made meanwhile
+    if (sort_outdated_)
+    {
+        StartSort();
+        return;
+    }
+
+    // Otherwise the order is current: cache it, then filter it as any cached order, with the tasks' current states
+    sorting_ = false;
+    orders_[static_cast<int>(request_sort_)]       = std::move(result.order);
+    orders_valid_[static_cast<int>(request_sort_)] = true;
+    Rebuild();
+}
+
+void TaskListModel::SortTasks(const SortInput& i_input, QPromise<SortResult>& io_promise)
+{
+    // Sort runs of SORT_CHUNK tasks, then merge them pairwise, checking between steps whether the sort was cancelled
+    // Filtering is left to FinishSort(), as the tasks' states may change meanwhile without changing the order
+    auto is_before = [&i_input](Task::Id i_left, Task::Id i_right)
+    {
+        return IsBefore(i_input.sort, i_input.keys, [&i_input](Task::Id i_id) -> const QString& { return i_input.names[i_id]; },
+                        i_left, i_right);
+    };
+    SortResult      result;
+    Task::IdVector& order = result.order;
+    size_t          count = i_input.ids.size();
+    result.generation = i_input.generation;
+    order             = i_input.ids;
+    for (size_t i=0; i<count; i+=SORT_CHUNK)
+    {
+        if (io_promise.isCanceled()) return;
+        std::sort(order.begin() + i, order.begin() + std::min(i + SORT_CHUNK, count), is_before);
+    }
+    for (size_t width=SORT_CHUNK; width<count; width*=2)
+        for (size_t i=0; i+width<count; i+=2*width)
+        {
+            if (io_promise.isCanceled()) return;
+            std::inplace_merge(order.begin() + i, order.begin() + i + width, order.begin() + std::min(i + 2*width, count), is_before);
+        }
+
+    if (io_promise.isCanceled()) return;
+    io_promise.addResult(std::move(result));
+}
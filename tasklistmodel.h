@@ -0,0 +1,148 @@
+//    This file is part of Telos
+//    Copyright (c) 2021, Cynical Tech Humor LLC
+
+//    Telos is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    Telos is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with Telos.  If not, see <https://www.gnu.org/licenses/>.
+
+//    Source code is available at:
+//    <https://github.com/CynicalTechHumor/Telos>
+
+#ifndef TASKLISTMODEL_H
+#define TASKLISTMODEL_H
+
+#include "task.h"
+
+#include <QAbstractListModel>
+#include <QFutureWatcher>
+#include <QPromise>
+
+#include <memory>
+#include <vector>
+
+// Selected filter
+enum class TaskFilter {kCurrent, kCompleted, kPending, kAll};
+
+// Sorting options
+enum class TaskSort {kName, kDeadline};
+
+// TaskListModel()
+// Model behind the displayed task list: the IDs of a list's tasks that pass the filter, in sort order
+// Rows follow the list's events one task at a time; large lists are sorted in the background
+class TaskListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+
+    explicit TaskListModel(QObject* parent = nullptr);
+    ~TaskListModel();
+
+    // SetTasks()
+    // Show the tasks of a list that pass a filter, sorted (nullptr list to show nothing)
+    // Does nothing if they're already shown; a background sort emits modelReset() once done
+    void SetTasks (TaskList*, TaskFilter, TaskSort);
+
+    // Lists of at least this many tasks are sorted in the background, unless their order is cached
+    static constexpr int ASYNC_SORT_TASKS = 10000;
+
+    // GetTask(), GetRow()
+    // Task shown in a row (nullptr if out of range or since removed), and the row showing a task (-1 if none)
+    Task* GetTask (int i_row) const;
+    Task* GetTask (const QModelIndex& i_index) const { return i_index.isValid() ? GetTask(i_index.row()) : nullptr; }
+    int   GetRow  (const Task*) const;
+
+    // UpdateDirty()
+    // Repaint rows whose tasks may have been saved or changed since (tasks with unsaved changes are in italics)
+    void UpdateDirty (void);
+
+    // QAbstractListModel
+    int      rowCount (const QModelIndex& i_parent = QModelIndex())                const override;
+    QVariant data     (const QModelIndex& i_index, int i_role = Qt::DisplayRole) const override;
+
+private:
+
+    // SortKey()
+    // A task's deadline as a number, and its name's first four UTF-16 code units packed to compare as QString does
+    struct SortKey
+    {
+        qint64   deadline;  // Milliseconds since epoch; invalid deadlines sort first, as with QDateTime
+        uint64_t name;
+    };
+
+    // SortInput(), SortResult()
+    // Snapshot of a list to sort on a worker thread, and the sorted order of every task
+    struct SortInput
+    {
+        uint64_t             generation;
+        TaskSort             sort;
+        Task::IdVector       ids;
+        std::vector<SortKey> keys;
+        std::vector<QString> names;
+    };
+    struct SortResult
+    {
+        uint64_t       generation = 0;
+        Task::IdVector order;
+    };
+
+    static constexpr int    SORT_COUNT = 2;      // Number of TaskSort options
+    static constexpr size_t SORT_CHUNK = 16384;  // Tasks sorted between checks for cancellation
+
+    TaskList*                  list_;
+    TaskFilter                 filter_;                      // Filter and sort of the rows shown
+    TaskSort                   sort_;
+    TaskFilter                 request_filter_;              // Latest filter and sort requested, which may still be sorting
+    TaskSort                   request_sort_;
+    Task::IdVector             rows_;                        // Task ID shown in each row
+    std::vector<int>           row_of_id_;                   // Row showing each task ID, -1 if not shown
+    std::vector<SortKey>       keys_;                        // Sort key of each task ID, kept up to date with the list's events
+    Task::IdVector             orders_[SORT_COUNT];          // Every task of the list in each sort order, if valid
+    bool                       orders_valid_[SORT_COUNT];
+    QFutureWatcher<SortResult> sort_watcher_;
+    uint64_t                   sort_generation_;             // Generation of the latest sort started; earlier results are dropped
+    bool                       sorting_;                     // A sort for the latest request is running
+    bool                       sort_outdated_;               // Tasks were added, removed or reordered since it started
+
+    // IsShown(), IsBefore()
+    // Whether a task passes the filter, and whether it sorts before another (ties broken by ID)
+    // The static IsBefore() also works from a snapshot, looking names up with i_name_of(ID)
+    bool IsShown  (Task::Id)                          const;
+    bool IsBefore (Task::Id i_left, Task::Id i_right) const;
+    template<typename NameOf>
+    static bool IsBefore (TaskSort, const std::vector<SortKey>&, const NameOf& i_name_of, Task::Id i_left, Task::Id i_right);
+
+    // UpdateKey(), UpdateKeys()
+    // Compute the sort key of one task, or of every task (dropping the cached orders)
+    void UpdateKey  (Task::Id);
+    void UpdateKeys (void);
+
+    // Rebuild(), Clear(), OnTaskEvent()
+    // Rebuild every row for the latest request; show no rows; apply one event of the list to the rows it affects
+    void Rebuild     (void);
+    void Clear       (void);
+    void OnTaskEvent (const TaskEvent&);
+
+    // StartSort(), CancelSort(), FinishSort(), SortTasks()
+    // Start, drop or finish a sort of the latest request on a worker thread; the work done on that thread
+    void        StartSort  (void);
+    void        CancelSort (void);
+    void        FinishSort (void);
+    static void SortTasks  (const SortInput&, QPromise<SortResult>&);
+
+    // FindPosition(), UpdateRowsOf()
+    // First row in [i_first, i_last) that a task sorts before (binary search); refresh row_of_id_ for rows [i_first, i_last)
+    int  FindPosition (Task::Id, int i_first, int i_last) const;
+    void UpdateRowsOf (int i_first, int i_last);
+};
+
+#endif // TASKLISTMODEL_H
@@ -0,0 +1,139 @@
+//    This file is part of Telos
+//    Copyright (c) 2021, Cynical Tech Humor LLC
+
+//    Telos is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    Telos is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with Telos.  If not, see <https://www.gnu.org/licenses/>.
+
+//    Source code is available at:
+//    <https://github.com/CynicalTechHumor/Telos>
+
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// SlabPool()
+// Allocates objects of one type out of large slabs; objects never move, and freed slots are reused first
+// The owner must Destroy() every object it created before Release()/destruction frees the slabs
+template <typename T>
+class SlabPool
+{
+public:
+
+    SlabPool() : next_slot_(0), slab_size_(0) {}
+    SlabPool(const SlabPool&)            = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    // ********
+    // Mutators
+    // ********
+
+    // Create()
+    // Construct an object in a free slot (or a new one), forwarding the input arguments to its constructor
+    template <typename... Args>
+    T* Create(Args&&... i_args)
+    {
+        void* slot = TakeSlot();
+        try
+        {
+            return new (slot) T(std::forward<Args>(i_args)...);
+        }
+        catch (...)
+        {
+            free_.push_back(static_cast<Slot*>(slot));
+            throw;
+        }
+    }
+
+    // Destroy()
+    // Destroy an object created by this pool; its slot is reused by the next Create()
+    void Destroy(T* i_ptr)
+    {
+        if (!i_ptr) return;
+        i_ptr->~T();
+        free_.push_back(reinterpret_cast<Slot*>(i_ptr));
+    }
+
+    // Reserve()
+    // Make sure at least i_count more objects can be created without allocating another slab
+    void Reserve(size_t i_count)
+    {
+        size_t available = free_.size() + (slabs_.empty() ? 0 : slabs_.back().size - next_slot_);
+        if (available < i_count) AddSlab(i_count - available);
+    }
+
+    // Release()
+    // Free every slab at once; all objects must already have been destroyed
+    void Release(void)
+    {
+        slabs_.clear();
+        free_.clear();
+        next_slot_ = 0;
+        slab_size_ = 0;
+    }
+
+private:
+
+    // Raw storage for one object
+    struct alignas(T) Slot
+    {
+        unsigned char bytes[sizeof(T)];
+    };
+
+    struct Slab
+    {
+        std::unique_ptr<Slot[]> slots;
+        size_t                  size;
+    };
+
+    // Slabs double in size (64 slots up to 4096), so small lists stay small and large lists need few slabs
+    static constexpr size_t MIN_SLAB = 64;
+    static constexpr size_t MAX_SLAB = 4096;
+
+    std::vector<Slab>  slabs_;
+    std::vector<Slot*> free_;       // Slots of destroyed objects
+    size_t             next_slot_;  // First never-used slot of the last slab
+    size_t             slab_size_;  // Size of the next slab to allocate
+
+    void* TakeSlot(void)
+    {
+        if (!free_.empty())
+        {
+            Slot* slot = free_.back();
+            free_.pop_back();
+            return slot;
+        }
+        if (slabs_.empty() || next_slot_ == slabs_.back().size) AddSlab(0);
+        return &slabs_.back().slots[next_slot_++];
+    }
+
+    void AddSlab(size_t i_min_size)
+    {
+        // Put the unused tail of the current slab on the free list, so it isn't lost
+        if (!slabs_.empty())
+            for (; next_slot_ < slabs_.back().size; ++next_slot_)
+                free_.push_back(&slabs_.back().slots[next_slot_]);
+
+        slab_size_ = slab_size_ ? std::min(slab_size_ * 2, MAX_SLAB) : MIN_SLAB;
+        size_t size = std::max(slab_size_, i_min_size);
+        slabs_.push_back(Slab{std::unique_ptr<Slot[]>(new Slot[size]), size});
+        next_slot_ = 0;
+    }
+};
+
+#endif // TASKPOOL_H